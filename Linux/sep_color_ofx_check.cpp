@@ -0,0 +1,1305 @@
+// Integration checks for the OpenFX build (make check).
+// A minimal in-process OFX host: the property, parameter, image effect and
+// multithread suites, backed by plain maps and heap images sized exactly
+// to their bounds. It links sep_color_OFX.cpp directly and drives it
+// through OfxGetPlugin() / mainEntry like a real host: load, describe,
+// describe-in-context, render, unload. Built with AddressSanitizer by
+// default, so a read or write outside a clip image fails the run.
+//
+//   sep_color_ofx_check [--filter TEXT]
+
+#include "ofxCore.h"
+
+#include "ofxImageEffect.h"
+
+#include "ofxMultiThread.h"
+
+#include "ofxParam.h"
+
+#include "ofxProperty.h"
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <cstdarg>
+
+#include <cstdio>
+
+#include <cstring>
+
+#include <map>
+
+#include <string>
+
+#include <thread>
+
+#include <vector>
+
+OfxExport int OfxGetNumberOfPlugins(void);
+
+OfxExport OfxPlugin *OfxGetPlugin(int nth);
+
+// -------------------------------------------------------------
+
+// Property suite
+
+// -------------------------------------------------------------
+
+struct Property
+{
+	std::vector<std::string> strings;
+	std::vector<double> doubles;
+	std::vector<int> ints;
+	std::vector<void *> pointers;
+};
+
+struct PropertySet
+{
+	std::map<std::string, Property> values;
+
+	OfxPropertySetHandle Handle()
+	{
+		return reinterpret_cast<OfxPropertySetHandle>(this);
+	}
+};
+
+static PropertySet &Props(OfxPropertySetHandle handle)
+
+{
+
+	return *reinterpret_cast<PropertySet *>(handle);
+
+}
+
+template<typename ValueType>
+
+static OfxStatus SetValue(std::vector<ValueType> &values, int index, const ValueType &value)
+
+{
+
+	if (index < 0)
+
+	{
+
+		return kOfxStatErrBadIndex;
+
+	}
+
+	if (static_cast<int>(values.size()) <= index)
+
+	{
+
+		values.resize(static_cast<std::size_t>(index) + 1);
+
+	}
+
+	values[static_cast<std::size_t>(index)] = value;
+
+	return kOfxStatOK;
+
+}
+
+template<typename ValueType>
+
+static OfxStatus GetValue(const std::vector<ValueType> &values, int index, ValueType *value)
+
+{
+
+	if (index < 0 || index >= static_cast<int>(values.size()))
+
+	{
+
+		return kOfxStatErrBadIndex;
+
+	}
+
+	*value = values[static_cast<std::size_t>(index)];
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus PropSetPointer(OfxPropertySetHandle handle, const char *name, int index, void *value)
+
+{
+
+	return SetValue(Props(handle).values[name].pointers, index, value);
+
+}
+
+static OfxStatus PropSetString(OfxPropertySetHandle handle, const char *name, int index, const char *value)
+
+{
+
+	return SetValue(Props(handle).values[name].strings, index, std::string(value));
+
+}
+
+static OfxStatus PropSetDouble(OfxPropertySetHandle handle, const char *name, int index, double value)
+
+{
+
+	return SetValue(Props(handle).values[name].doubles, index, value);
+
+}
+
+static OfxStatus PropSetInt(OfxPropertySetHandle handle, const char *name, int index, int value)
+
+{
+
+	return SetValue(Props(handle).values[name].ints, index, value);
+
+}
+
+static OfxStatus PropGetPointer(OfxPropertySetHandle handle, const char *name, int index, void **value)
+
+{
+
+	return GetValue(Props(handle).values[name].pointers, index, value);
+
+}
+
+static OfxStatus PropGetString(OfxPropertySetHandle handle, const char *name, int index, char **value)
+
+{
+
+	std::vector<std::string> &strings = Props(handle).values[name].strings;
+
+	if (index < 0 || index >= static_cast<int>(strings.size()))
+
+	{
+
+		return kOfxStatErrBadIndex;
+
+	}
+
+	*value = &strings[static_cast<std::size_t>(index)][0];
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus PropGetDouble(OfxPropertySetHandle handle, const char *name, int index, double *value)
+
+{
+
+	return GetValue(Props(handle).values[name].doubles, index, value);
+
+}
+
+static OfxStatus PropGetInt(OfxPropertySetHandle handle, const char *name, int index, int *value)
+
+{
+
+	return GetValue(Props(handle).values[name].ints, index, value);
+
+}
+
+static OfxStatus PropGetDoubleN(OfxPropertySetHandle handle, const char *name, int count, double *value)
+
+{
+
+	for (int i = 0; i < count; ++i)
+
+	{
+
+		if (PropGetDouble(handle, name, i, value + i) != kOfxStatOK)
+
+		{
+
+			return kOfxStatErrBadIndex;
+
+		}
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus PropGetIntN(OfxPropertySetHandle handle, const char *name, int count, int *value)
+
+{
+
+	for (int i = 0; i < count; ++i)
+
+	{
+
+		if (PropGetInt(handle, name, i, value + i) != kOfxStatOK)
+
+		{
+
+			return kOfxStatErrBadIndex;
+
+		}
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+// -------------------------------------------------------------
+
+// Parameter suite
+
+// -------------------------------------------------------------
+
+struct Param
+{
+	std::string type;
+	PropertySet props;
+	double values[3] = {};							// Double, Double2D, RGB
+	int value = 0;									// Choice, Boolean
+};
+
+struct ParamSet
+{
+	std::map<std::string, Param> params;
+};
+
+static OfxStatus ParamDefine(OfxParamSetHandle handle, const char *type, const char *name, OfxPropertySetHandle *props)
+
+{
+
+	Param &param = reinterpret_cast<ParamSet *>(handle)->params[name];
+
+	param.type = type;
+
+	if (props != nullptr)
+
+	{
+
+		*props = param.props.Handle();
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus ParamGetHandle(OfxParamSetHandle handle, const char *name, OfxParamHandle *param, OfxPropertySetHandle *props)
+
+{
+
+	std::map<std::string, Param> &params = reinterpret_cast<ParamSet *>(handle)->params;
+
+	const auto found = params.find(name);
+
+	if (found == params.end())
+
+	{
+
+		return kOfxStatErrUnknown;
+
+	}
+
+	*param = reinterpret_cast<OfxParamHandle>(&found->second);
+
+	if (props != nullptr)
+
+	{
+
+		*props = found->second.props.Handle();
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus ParamGetValueAtTime(OfxParamHandle handle, OfxTime time, ...)
+
+{
+
+	(void)time;
+
+	const Param &param = *reinterpret_cast<const Param *>(handle);
+
+	va_list args;
+
+	va_start(args, time);
+
+	if (param.type == kOfxParamTypeChoice || param.type == kOfxParamTypeBoolean)
+
+	{
+
+		*va_arg(args, int *) = param.value;
+
+	}
+
+	else
+
+	{
+
+		const int count = param.type == kOfxParamTypeRGB ? 3 : param.type == kOfxParamTypeDouble2D ? 2 : 1;
+
+		for (int i = 0; i < count; ++i)
+
+		{
+
+			*va_arg(args, double *) = param.values[i];
+
+		}
+
+	}
+
+	va_end(args);
+
+	return kOfxStatOK;
+
+}
+
+// -------------------------------------------------------------
+
+// Image effect suite
+
+// -------------------------------------------------------------
+
+// Pixels of exactly (bounds) x (bytes per pixel), so any access past the
+// image is a heap overflow under AddressSanitizer
+struct HostImage
+{
+	PropertySet props;
+	std::vector<unsigned char> pixels;
+};
+
+struct Clip
+{
+	PropertySet props;
+	HostImage *image = nullptr;
+};
+
+struct Effect
+{
+	PropertySet props;
+	ParamSet params;
+	std::map<std::string, Clip> clips;
+	std::atomic<int> polls{0};
+	int abort_after_polls = -1;						// -1: never abort
+};
+
+static Effect &EffectOf(OfxImageEffectHandle handle)
+
+{
+
+	return *reinterpret_cast<Effect *>(handle);
+
+}
+
+static OfxStatus EffectGetPropertySet(OfxImageEffectHandle handle, OfxPropertySetHandle *props)
+
+{
+
+	*props = EffectOf(handle).props.Handle();
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus EffectGetParamSet(OfxImageEffectHandle handle, OfxParamSetHandle *params)
+
+{
+
+	*params = reinterpret_cast<OfxParamSetHandle>(&EffectOf(handle).params);
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus ClipDefine(OfxImageEffectHandle handle, const char *name, OfxPropertySetHandle *props)
+
+{
+
+	*props = EffectOf(handle).clips[name].props.Handle();
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus ClipGetHandle(OfxImageEffectHandle handle, const char *name, OfxImageClipHandle *clip, OfxPropertySetHandle *props)
+
+{
+
+	std::map<std::string, Clip> &clips = EffectOf(handle).clips;
+
+	const auto found = clips.find(name);
+
+	if (found == clips.end())
+
+	{
+
+		return kOfxStatErrBadHandle;
+
+	}
+
+	*clip = reinterpret_cast<OfxImageClipHandle>(&found->second);
+
+	if (props != nullptr)
+
+	{
+
+		*props = found->second.props.Handle();
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus ClipGetImage(OfxImageClipHandle handle, OfxTime time, const OfxRectD *region, OfxPropertySetHandle *image)
+
+{
+
+	(void)time;
+
+	(void)region;
+
+	HostImage *host_image = reinterpret_cast<Clip *>(handle)->image;
+
+	if (host_image == nullptr)
+
+	{
+
+		return kOfxStatFailed;
+
+	}
+
+	*image = host_image->props.Handle();
+
+	return kOfxStatOK;
+
+}
+
+static int g_released_images = 0;
+
+static OfxStatus ClipReleaseImage(OfxPropertySetHandle image)
+
+{
+
+	(void)image;
+
+	++g_released_images;
+
+	return kOfxStatOK;
+
+}
+
+static int EffectAbort(OfxImageEffectHandle handle)
+
+{
+
+	Effect &effect = EffectOf(handle);
+
+	const int polls = ++effect.polls;
+
+	return effect.abort_after_polls >= 0 && polls > effect.abort_after_polls ? 1 : 0;
+
+}
+
+// -------------------------------------------------------------
+
+// Multithread suite
+
+// -------------------------------------------------------------
+
+static unsigned int g_host_threads = 4;
+
+static OfxStatus MultiThread(OfxThreadFunctionV1 func, unsigned int threads, void *arg)
+
+{
+
+	std::vector<std::thread> workers;
+
+	for (unsigned int i = 1; i < threads; ++i)
+
+	{
+
+		workers.emplace_back(func, i, threads, arg);
+
+	}
+
+	func(0, threads, arg);
+
+	for (std::thread &worker : workers)
+
+	{
+
+		worker.join();
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus MultiThreadNumCPUs(unsigned int *threads)
+
+{
+
+	*threads = g_host_threads;
+
+	return kOfxStatOK;
+
+}
+
+// -------------------------------------------------------------
+
+// Host
+
+// -------------------------------------------------------------
+
+static OfxPropertySuiteV1 g_property_suite;
+
+static OfxParameterSuiteV1 g_parameter_suite;
+
+static OfxImageEffectSuiteV1 g_effect_suite;
+
+static OfxMultiThreadSuiteV1 g_thread_suite;
+
+static const void *FetchSuite(OfxPropertySetHandle host, const char *name, int version)
+
+{
+
+	(void)host;
+
+	if (version != 1)
+
+	{
+
+		return nullptr;
+
+	}
+
+	if (std::strcmp(name, kOfxPropertySuite) == 0)
+
+	{
+
+		return &g_property_suite;
+
+	}
+
+	if (std::strcmp(name, kOfxParameterSuite) == 0)
+
+	{
+
+		return &g_parameter_suite;
+
+	}
+
+	if (std::strcmp(name, kOfxImageEffectSuite) == 0)
+
+	{
+
+		return &g_effect_suite;
+
+	}
+
+	if (std::strcmp(name, kOfxMultiThreadSuite) == 0)
+
+	{
+
+		return &g_thread_suite;
+
+	}
+
+	return nullptr;
+
+}
+
+static PropertySet g_host_props;
+
+static OfxHost g_host = { g_host_props.Handle(), FetchSuite };
+
+// Suites are filled member by member: only what the plugin calls, and the
+// same code compiles against any OFX header revision
+static void InitSuites()
+
+{
+
+	g_property_suite.propSetPointer = PropSetPointer;
+
+	g_property_suite.propSetString = PropSetString;
+
+	g_property_suite.propSetDouble = PropSetDouble;
+
+	g_property_suite.propSetInt = PropSetInt;
+
+	g_property_suite.propGetPointer = PropGetPointer;
+
+	g_property_suite.propGetString = PropGetString;
+
+	g_property_suite.propGetDouble = PropGetDouble;
+
+	g_property_suite.propGetInt = PropGetInt;
+
+	g_property_suite.propGetDoubleN = PropGetDoubleN;
+
+	g_property_suite.propGetIntN = PropGetIntN;
+
+	g_parameter_suite.paramDefine = ParamDefine;
+
+	g_parameter_suite.paramGetHandle = ParamGetHandle;
+
+	g_parameter_suite.paramGetValueAtTime = ParamGetValueAtTime;
+
+	g_effect_suite.getPropertySet = EffectGetPropertySet;
+
+	g_effect_suite.getParamSet = EffectGetParamSet;
+
+	g_effect_suite.clipDefine = ClipDefine;
+
+	g_effect_suite.clipGetHandle = ClipGetHandle;
+
+	g_effect_suite.clipGetImage = ClipGetImage;
+
+	g_effect_suite.clipReleaseImage = ClipReleaseImage;
+
+	g_effect_suite.abort = EffectAbort;
+
+	g_thread_suite.multiThread = MultiThread;
+
+	g_thread_suite.multiThreadNumCPUs = MultiThreadNumCPUs;
+
+}
+
+struct Depth
+{
+	const char *name;
+	int bytes_per_pixel;
+};
+
+static const Depth DEPTHS[] = {
+	{ kOfxBitDepthByte, 4 },
+	{ kOfxBitDepthShort, 8 },
+	{ kOfxBitDepthFloat, 16 }
+};
+
+/**
+ * Fill `image` with deterministic pixels covering `bounds`. Float images
+ * get values in [0, 1]. With `bottom_up` false the rows are stored top row
+ * first and rowbytes is negative, which OFX allows.
+ */
+static void MakeImage(HostImage &image, const Depth &depth, const OfxRectI &bounds, unsigned int seed, bool bottom_up = true)
+
+{
+
+	const int width = bounds.x2 - bounds.x1;
+
+	const int height = bounds.y2 - bounds.y1;
+
+	const int rowbytes = width * depth.bytes_per_pixel;
+
+	image.pixels.assign(static_cast<std::size_t>(rowbytes) * height, 0);
+
+	for (std::size_t i = 0; i < image.pixels.size(); ++i)
+
+	{
+
+		image.pixels[i] = static_cast<unsigned char>((i * 2654435761u + seed) >> 13);
+
+	}
+
+	if (std::strcmp(depth.name, kOfxBitDepthFloat) == 0)
+
+	{
+
+		for (std::size_t i = 0; i < image.pixels.size(); i += sizeof(float))
+
+		{
+
+			const float value = static_cast<float>(image.pixels[i] % 200) / 199.0f;
+
+			std::memcpy(&image.pixels[i], &value, sizeof(float));
+
+		}
+
+	}
+
+	unsigned char *data = image.pixels.data();
+
+	OfxPropertySetHandle props = image.props.Handle();
+
+	if (!bottom_up && height > 0)
+
+	{
+
+		data += static_cast<std::size_t>(height - 1) * rowbytes;
+
+	}
+
+	PropSetPointer(props, kOfxImagePropData, 0, data);
+
+	PropSetInt(props, kOfxImagePropRowBytes, 0, bottom_up ? rowbytes : -rowbytes);
+
+	PropSetInt(props, kOfxImagePropBounds, 0, bounds.x1);
+
+	PropSetInt(props, kOfxImagePropBounds, 1, bounds.y1);
+
+	PropSetInt(props, kOfxImagePropBounds, 2, bounds.x2);
+
+	PropSetInt(props, kOfxImagePropBounds, 3, bounds.y2);
+
+	PropSetString(props, kOfxImageEffectPropPixelDepth, 0, depth.name);
+
+	PropSetString(props, kOfxImageEffectPropComponents, 0, kOfxImageComponentRGBA);
+
+	PropSetDouble(props, kOfxImagePropPixelAspectRatio, 0, 1.0);
+
+}
+
+// -------------------------------------------------------------
+
+// Checks
+
+// -------------------------------------------------------------
+
+static OfxPlugin *g_plugin = nullptr;
+
+static Effect g_instance;
+
+static int g_failures = 0;
+
+static void Fail(const char *format, ...)
+
+{
+
+	if (++g_failures <= 8)
+
+	{
+
+		va_list args;
+
+		va_start(args, format);
+
+		std::printf("    ");
+
+		std::vprintf(format, args);
+
+		std::printf("\n");
+
+		va_end(args);
+
+	}
+
+}
+
+static OfxStatus RenderFrame(HostImage &src, HostImage &dst, const OfxRectI &window, double scale = 1.0, unsigned int threads = 1)
+
+{
+
+	g_instance.clips[kOfxImageEffectSimpleSourceClipName].image = &src;
+
+	g_instance.clips[kOfxImageEffectOutputClipName].image = &dst;
+
+	g_host_threads = threads;
+
+	PropertySet args;
+
+	PropSetDouble(args.Handle(), kOfxPropTime, 0, 0.0);
+
+	PropSetInt(args.Handle(), kOfxImageEffectPropRenderWindow, 0, window.x1);
+
+	PropSetInt(args.Handle(), kOfxImageEffectPropRenderWindow, 1, window.y1);
+
+	PropSetInt(args.Handle(), kOfxImageEffectPropRenderWindow, 2, window.x2);
+
+	PropSetInt(args.Handle(), kOfxImageEffectPropRenderWindow, 3, window.y2);
+
+	PropSetDouble(args.Handle(), kOfxImageEffectPropRenderScale, 0, scale);
+
+	PropSetDouble(args.Handle(), kOfxImageEffectPropRenderScale, 1, scale);
+
+	return g_plugin->mainEntry(kOfxImageEffectActionRender, &g_instance, args.Handle(), nullptr);
+
+}
+
+static void SetParams(int mode)
+
+{
+
+	std::map<std::string, Param> &params = g_instance.params.params;
+
+	params["anchor"].values[0] = 500.3;
+
+	params["anchor"].values[1] = 260.7;
+
+	params["mode"].value = mode;
+
+	params["angle"].values[0] = 30.0;
+
+	params["radius"].values[0] = 180.0;
+
+	params["color"].values[0] = 1.0;
+
+	params["color"].values[1] = 0.5;
+
+	params["color"].values[2] = 0.0;
+
+	params["antialias"].value = 1;
+
+	params["edgeWidth"].values[0] = 6.0;
+
+	params["draft"].value = 0;
+
+	params["incremental"].value = 0;
+
+}
+
+// Every depth, mode and render scale: odd-sized tiles rendered on four
+// host threads reproduce the single-threaded full frame, every pixel is
+// written, and both clip images are released
+static void CheckTilesVsFull()
+
+{
+
+	for (const Depth &depth : DEPTHS)
+
+	{
+
+		for (int mode = 0; mode <= 1; ++mode)
+
+		{
+
+			for (double scale : { 1.0, 0.5 })
+
+			{
+
+				SetParams(mode);
+
+				const OfxRectI bounds = { -10, -20, static_cast<int>(1000 * scale) - 10, static_cast<int>(540 * scale) - 20 };
+
+				HostImage src, full, tiled;
+
+				MakeImage(src, depth, bounds, 7, false);
+
+				MakeImage(full, depth, bounds, 99);
+
+				MakeImage(tiled, depth, bounds, 99);
+
+				const std::vector<unsigned char> before = full.pixels;
+
+				const int released = g_released_images;
+
+				OfxStatus status = RenderFrame(src, full, bounds, scale);
+
+				if (status != kOfxStatOK || g_released_images - released != 2)
+
+				{
+
+					Fail("%s mode %d scale %.1f: status %d, %d of 2 images released", depth.name, mode, scale, status, g_released_images - released);
+
+				}
+
+				for (int y = bounds.y1; y < bounds.y2; y += 97)
+
+				{
+
+					for (int x = bounds.x1; x < bounds.x2; x += 333)
+
+					{
+
+						const OfxRectI tile = { x, y, std::min(x + 333, bounds.x2), std::min(y + 97, bounds.y2) };
+
+						status = RenderFrame(src, tiled, tile, scale, 4);
+
+						if (status != kOfxStatOK)
+
+						{
+
+							Fail("%s mode %d scale %.1f: tile (%d, %d) status %d", depth.name, mode, scale, x, y, status);
+
+						}
+
+					}
+
+				}
+
+				if (tiled.pixels != full.pixels)
+
+				{
+
+					Fail("%s mode %d scale %.1f: tiles differ from the full frame", depth.name, mode, scale);
+
+				}
+
+				if (full.pixels == before)
+
+				{
+
+					Fail("%s mode %d scale %.1f: nothing written", depth.name, mode, scale);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+// A host that cancels at its third abort poll gets kOfxStatFailed back
+static void CheckAbort()
+
+{
+
+	SetParams(1);
+
+	const OfxRectI bounds = { 0, 0, 7680, 4320 };
+
+	HostImage src, dst;
+
+	MakeImage(src, DEPTHS[0], bounds, 1);
+
+	MakeImage(dst, DEPTHS[0], bounds, 2);
+
+	g_instance.polls = 0;
+
+	g_instance.abort_after_polls = 2;
+
+	const OfxStatus status = RenderFrame(src, dst, bounds, 1.0, 4);
+
+	g_instance.abort_after_polls = -1;
+
+	if (status != kOfxStatFailed)
+
+	{
+
+		Fail("status %d after %d polls", status, g_instance.polls.load());
+
+	}
+
+}
+
+// Images the plugin cannot render are refused, without touching the
+// output: mixed depths, and a source or output that does not cover the
+// render window (a 64x64 source under a 256x256 window read past the
+// source before the bounds check)
+static void CheckRejectedImages()
+
+{
+
+	SetParams(1);
+
+	const OfxRectI small = { 0, 0, 64, 64 };
+
+	const OfxRectI large = { 0, 0, 256, 256 };
+
+	const OfxRectI shifted = { 32, -16, 288, 240 };
+
+	struct Case
+	{
+		const char *name;
+		OfxRectI src_bounds;
+		OfxRectI dst_bounds;
+		int src_depth_offset;						// source depth: DEPTHS[(d + offset) % 3]
+	};
+
+	const Case cases[] = {
+		{ "mixed depths", large, large, 1 },
+		{ "64x64 source, 256x256 window", small, large, 0 },
+		{ "64x64 output, 256x256 window", large, small, 0 },
+		{ "source offset from the window", shifted, large, 0 }
+	};
+
+	for (const Case &c : cases)
+
+	{
+
+		for (int d = 0; d < 3; ++d)
+
+		{
+
+			const Depth &depth = DEPTHS[d];
+
+			const Depth &src_depth = DEPTHS[(d + c.src_depth_offset) % 3];
+
+			HostImage src, dst;
+
+			MakeImage(src, src_depth, c.src_bounds, 3);
+
+			MakeImage(dst, depth, c.dst_bounds, 4);
+
+			const std::vector<unsigned char> before = dst.pixels;
+
+			const OfxStatus status = RenderFrame(src, dst, large, 1.0, 4);
+
+			if (status != kOfxStatErrImageFormat || dst.pixels != before)
+
+			{
+
+				Fail("%s (%s): status %d, output %s", c.name, depth.name, status, dst.pixels == before ? "untouched" : "written");
+
+			}
+
+		}
+
+	}
+
+}
+
+// Incremental (Static Input): an edge moving over a static source renders
+// the same frames as with the option off, on a fresh output buffer every
+// frame. A new source identifier, color, mode or window, and a frame after
+// an aborted one, are not served from the stale frame.
+static void CheckIncremental()
+
+{
+
+	const OfxRectI bounds = { -8, 4, 632, 364 };
+
+	const OfxRectI tile = { 100, 50, 300, 200 };
+
+	for (const Depth &depth : DEPTHS)
+
+	{
+
+		SetParams(0);
+
+		std::map<std::string, Param> &params = g_instance.params.params;
+
+		HostImage src, dst, reference;
+
+		MakeImage(src, depth, bounds, 5);
+
+		PropSetString(src.props.Handle(), kOfxImagePropUniqueIdentifier, 0, "source-1");
+
+		for (int frame = 0; frame < 24; ++frame)
+
+		{
+
+			params["anchor"].values[0] += 3.1;
+
+			params["anchor"].values[1] -= 1.7;
+
+			params["angle"].values[0] += 1.0;
+
+			params["radius"].values[0] += 2.5;
+
+			params["mode"].value = frame >= 12 ? 1 : 0;
+
+			params["color"].values[1] = frame >= 8 ? 0.25 : 0.5;
+
+			if (frame == 16)
+
+			{
+
+				MakeImage(src, depth, bounds, 40u << 13);
+
+				PropSetString(src.props.Handle(), kOfxImagePropUniqueIdentifier, 0, "source-2");
+
+			}
+
+			// A frame cancelled after its first slice, with the edge 40 px
+			// away, leaves the cache half written
+			if (frame == 22)
+
+			{
+
+				params["incremental"].value = 1;
+
+				params["anchor"].values[0] += 40.0;
+
+				g_instance.polls = 0;
+
+				g_instance.abort_after_polls = 0;
+
+				const OfxStatus aborted = RenderFrame(src, dst, bounds, 1.0, 1);
+
+				g_instance.abort_after_polls = -1;
+
+				params["anchor"].values[0] -= 40.0;
+
+				if (aborted != kOfxStatFailed)
+
+				{
+
+					Fail("%s frame %d: status %d for a cancelled frame", depth.name, frame, aborted);
+
+				}
+
+			}
+
+			MakeImage(reference, depth, bounds, 100 + frame);
+
+			MakeImage(dst, depth, bounds, 200 + frame);
+
+			params["incremental"].value = 0;
+
+			OfxStatus status = RenderFrame(src, reference, bounds, 1.0, 4);
+
+			params["incremental"].value = 1;
+
+			if (frame == 20)
+
+			{
+
+				HostImage part;
+
+				MakeImage(part, depth, bounds, 7);
+
+				RenderFrame(src, part, tile, 1.0, 4);
+
+			}
+
+			status = status == kOfxStatOK ? RenderFrame(src, dst, bounds, 1.0, 4) : status;
+
+			if (status != kOfxStatOK || dst.pixels != reference.pixels)
+
+			{
+
+				Fail("%s frame %d: status %d, output %s the full render", depth.name, frame, status, dst.pixels == reference.pixels ? "matches" : "differs from");
+
+			}
+
+		}
+
+		// The identifier is the only content check: new pixels under the
+		// old one still come from the cached frame, which shows it is used
+		MakeImage(src, depth, bounds, 90u << 13);
+
+		MakeImage(reference, depth, bounds, 12);
+
+		MakeImage(dst, depth, bounds, 13);
+
+		params["incremental"].value = 0;
+
+		RenderFrame(src, reference, bounds, 1.0, 4);
+
+		params["incremental"].value = 1;
+
+		RenderFrame(src, dst, bounds, 1.0, 4);
+
+		if (dst.pixels == reference.pixels)
+
+		{
+
+			Fail("%s: a frame with an unchanged identifier was rendered in full", depth.name);
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Runner
+
+// -------------------------------------------------------------
+
+struct Check
+{
+	const char *name;
+	void (*run)();
+};
+
+static const Check CHECKS[] = {
+	{ "tiles-vs-full", CheckTilesVsFull },
+	{ "abort", CheckAbort },
+	{ "rejected-images", CheckRejectedImages },
+	{ "incremental", CheckIncremental }
+};
+
+int main(int argc, char **argv)
+
+{
+
+	const char *filter = argc == 3 && std::strcmp(argv[1], "--filter") == 0 ? argv[2] : nullptr;
+
+	if (argc != 1 && filter == nullptr)
+
+	{
+
+		std::fprintf(stderr, "usage: %s [--filter TEXT]\n", argv[0]);
+
+		return 2;
+
+	}
+
+	InitSuites();
+
+	if (OfxGetNumberOfPlugins() != 1 || (g_plugin = OfxGetPlugin(0)) == nullptr)
+
+	{
+
+		std::printf("FAIL plugin exports\n");
+
+		return 1;
+
+	}
+
+	g_plugin->setHost(&g_host);
+
+	if (g_plugin->mainEntry(kOfxActionLoad, nullptr, nullptr, nullptr) != kOfxStatOK)
+
+	{
+
+		std::printf("FAIL load\n");
+
+		return 1;
+
+	}
+
+	Effect descriptor;
+
+	PropertySet context;
+
+	PropSetString(context.Handle(), kOfxImageEffectPropContext, 0, kOfxImageEffectContextFilter);
+
+	g_plugin->mainEntry(kOfxActionDescribe, &descriptor, nullptr, nullptr);
+
+	g_plugin->mainEntry(kOfxImageEffectActionDescribeInContext, &g_instance, context.Handle(), nullptr);
+
+	if (g_plugin->mainEntry(kOfxActionCreateInstance, &g_instance, nullptr, nullptr) != kOfxStatOK)
+
+	{
+
+		std::printf("FAIL create instance\n");
+
+		return 1;
+
+	}
+
+	std::printf("# %s %u.%u: %zu params, %zu clips\n", g_plugin->pluginIdentifier, g_plugin->pluginVersionMajor, g_plugin->pluginVersionMinor,
+		g_instance.params.params.size(), g_instance.clips.size());
+
+	int failed = 0;
+
+	int run = 0;
+
+	for (const Check &check : CHECKS)
+
+	{
+
+		if (filter != nullptr && std::strstr(check.name, filter) == nullptr)
+
+		{
+
+			continue;
+
+		}
+
+		g_failures = 0;
+
+		check.run();
+
+		std::printf("%s %s\n", g_failures == 0 ? "PASS" : "FAIL", check.name);
+
+		failed += g_failures != 0 ? 1 : 0;
+
+		++run;
+
+	}
+
+	g_plugin->mainEntry(kOfxActionDestroyInstance, &g_instance, nullptr, nullptr);
+
+	g_plugin->mainEntry(kOfxActionUnload, nullptr, nullptr, nullptr);
+
+	std::printf("# %d of %d checks passed\n", run - failed, run);
+
+	return failed != 0 ? 1 : 0;
+
+}
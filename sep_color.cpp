@@ -2,55 +2,29 @@
 
 #include "sep_color_Strings.h"
 
-#include <algorithm>
-
-#include <cmath>
-
-#include <cstring>
-
-#include <vector>
-
-// Named constants for magic numbers
-
-namespace Constants {
+#include "sep_color_Scheduler.h"
 
-	// Mathematical constants
+#include "sep_color_Autotune.h"
 
-	constexpr float PI = 3.14159265358979323846f;              // Pi constant
+#include "sep_color_Preview.h"
 
-	constexpr float INV_SQRT_2 = 0.70710678118654752440f;       // 1/sqrt(2) for edge width
+#include "sep_color_Telemetry.h"
 
-	constexpr float EDGE_WIDTH = INV_SQRT_2;                   // Anti-aliasing edge width (1/sqrt(2))
-
-	// Coverage thresholds for early-outs
-
-	constexpr float COVERAGE_EPSILON = 0.0001f;                // Below this: skip blending (use input)
-
-	constexpr float COVERAGE_FULL = 0.9999f;                   // Above this: full coverage (use effect color)
-
-	// Angle conversion
-
-	constexpr float DEG_TO_RAD = PI / 180.0f;                  // Degrees to radians conversion
-
-	// Color conversion constants
-
-	constexpr float COLOR_8BIT_MAX = 255.0f;                   // 8-bit color maximum
+#include <algorithm>
 
-	constexpr float COLOR_16BIT_MAX = 32768.0f;                // 16-bit color maximum
+#include <atomic>
 
-	constexpr float COLOR_SCALE_8_TO_16 = COLOR_16BIT_MAX / COLOR_8BIT_MAX;  // 32768/255
+#include <chrono>
 
-	constexpr float COLOR_SCALE_8_TO_FLOAT = 1.0f / COLOR_8BIT_MAX;          // 1/255
+#include <cmath>
 
-	constexpr float COLOR_ROUND_OFFSET_16 = 127.0f;            // Rounding offset for 16-bit conversion
+#include <cstdint>
 
-}
+#include <cstring>
 
-// Feature switches removed - always use PF_Iterate suites for MFR safety
+// Feature switches removed - always use AE's thread pool for MFR safety
 // Manual threading (std::thread) violates SDK guidelines
 
-// (forward declarations moved below with other fast paths)
-
 /**
  * Performance optimization overview for sep_color plugin
  *
@@ -60,31 +34,39 @@ namespace Constants {
  *    - 32-bit float (PF_PixelFloat: 0.0-1.0)
  *    - Template specialization (PixelTraits) for zero-overhead
  *
- * 1. MFR-safe threading using PF_Iterate suites
- *    - Uses AE's built-in thread pool (PF_OutFlag2_SUPPORTS_THREADED_RENDERING)
+ * 1. SmartFX render (PF_Cmd_SMART_PRE_RENDER / PF_Cmd_SMART_RENDER)
+ *    - Output rect = input rect; PF_Cmd_RENDER kept for other hosts
+ *    - Render fingerprint mixed into AE's cache GUID (GuidMixInPtr)
+ *
+ * 2. MFR-safe threading on AE's worker threads
+ *    - PF_Iterate8Suite1::iterate_generic runs one worker per processor
+ *      (PF_OutFlag2_SUPPORTS_THREADED_RENDERING)
+ *    - Workers pull row bands and run the span/SIMD kernels of the core
+ *      (sep_color_Scheduler.h)
  *    - No manual std::thread creation - avoids SDK violations
- *    - AE handles abort checking and parallelism
  *
- * 2. Analytical anti-aliasing
+ * 3. Analytical anti-aliasing
  *    - Line mode: distance-based gradient
  *    - Circle mode: radial gradient
  *    - Smooth transitions compatible with AE standards
  *
- * 3. Memory access optimizations
+ * 4. Memory access optimizations
  *    - Pointer references to avoid struct copies
  *    - Precomputed constants (edge_width, trig functions)
- *    - Early-outs for transparent pixels
+ *    - Row spans: pixels outside the AA band are copied or filled whole,
+ *      with no per-pixel coverage math
+ *    - Stride-aware ImageView (sep_color_Core.h): padded rowbytes, negative
+ *      (bottom-up) strides and sub-rect views for direct-memory kernels
  */
 
 // ============================================================================
 
 // PixelTraits: Type traits template for pixel depth specialization
+// (primary template is declared in sep_color_Core.h)
 
 // ============================================================================
 
-template<typename PixelType>
-
-struct PixelTraits;
+namespace SepColor {
 
 // Specialization for 8-bit pixels (PF_Pixel)
 
@@ -108,7 +90,7 @@ struct PixelTraits<PF_Pixel>
 
 	{
 
-		return static_cast<ChannelType>(src + (dst - src) * coverage + 0.5f);
+		return SepColor::BlendFixed(src, dst, SepColor::QuantizeCoverage(coverage));
 
 	}
 
@@ -174,7 +156,7 @@ struct PixelTraits<PF_Pixel16>
 
 	{
 
-		return static_cast<ChannelType>(src + (dst - src) * coverage + 0.5f);
+		return SepColor::BlendFixed(src, dst, SepColor::QuantizeCoverage(coverage));
 
 	}
 
@@ -296,459 +278,607 @@ struct PixelTraits<PF_PixelFloat>
 
 };
 
-// Legacy wrappers for backward compatibility
+} // namespace SepColor
+
+using SepColor::PixelTraits;
 
-static inline A_u_char FastBlend(A_u_char src, A_u_char dst, float coverage_alpha)
+// Filled at PF_Cmd_GLOBAL_SETUP, read-only while rendering (MFR-safe);
+// the preview governors lock internally. Holding the suites for the
+// plugin's lifetime keeps suite acquire/release (and AEGP_SuiteHandler)
+// off the per-frame path.
+
+struct SepColorGlobalData
 
 {
 
-	return PixelTraits<PF_Pixel>::Blend(src, dst, coverage_alpha);
+	const PF_Iterate8Suite1 *iterate8 = nullptr;
 
-}
+	const PF_HandleSuite1 *handles = nullptr;	// sequence data
+
+	const PF_EffectSequenceDataSuite1 *sequence_data = nullptr;	// AE 2022+ (MFR render reads), else null
 
-static inline A_u_short FastBlend16(A_u_short src, A_u_short dst, float coverage_alpha)
+	SepColor::SimdIsa simd_isa = SepColor::SIMD_SCALAR;	// autotuned kernel ISA
+
+	SepColor::PreviewGovernorMap previews;	// PF_Quality_LO frame-time budget, one per instance
+
+	SepColor::TelemetryRing *telemetry = nullptr;	// SEP_COLOR_TELEMETRY set, else null
+
+};
+
+static SepColorGlobalData g_global_data;
+
+// -------------------------------------------------------------
+
+// PF_EffectWorld -> ImageView (honours rowbytes padding)
+
+// -------------------------------------------------------------
+
+template<typename PixelType>
+
+static inline SepColor::ImageView<PixelType> ViewFromWorld(PF_EffectWorld *world, A_long origin_x = 0, A_long origin_y = 0)
 
 {
 
-	return PixelTraits<PF_Pixel16>::Blend(src, dst, coverage_alpha);
+	return SepColor::ImageView<PixelType>(
+
+		reinterpret_cast<PixelType *>(world->data),
+
+		world->width,
+
+		world->height,
+
+		static_cast<std::ptrdiff_t>(world->rowbytes),
+
+		origin_x,
+
+		origin_y);
 
 }
 
-static inline float FastBlendFloat(float src, float dst, float coverage_alpha)
+static float DownsampleX(const PF_InData *in_data)
 
 {
 
-	return PixelTraits<PF_PixelFloat>::Blend(src, dst, coverage_alpha);
+	return static_cast<float>(in_data->downsample_x.den) / static_cast<float>(in_data->downsample_x.num);
 
 }
 
-struct SepColorGlobalData
+static float DownsampleY(const PF_InData *in_data)
 
 {
 
-};
+	return static_cast<float>(in_data->downsample_y.den) / static_cast<float>(in_data->downsample_y.num);
 
-// -------------------------------------------------------------
+}
 
-// IterateRefcon structure definition for PF_Iterate callbacks
+// Frame-time budget of this render in ms: the Preview Budget param for
+// PF_Quality_LO renders, 0 (no budget) for final and render-queue renders
 
-// -------------------------------------------------------------
+static float PreviewBudget(const PF_InData *in_data, PF_ParamDef *params[])
 
-struct IterateRefcon {
-    int width;
-    int height;
-    float downsample_x;
-    float downsample_y;
-    int anchor_x;
-    int anchor_y;
-    float angle;
-    float radius;
-    int mode;
-    float edge_width;
-    float inv_edge_width;
-    PF_Pixel color8;
-    A_u_short r16, g16, b16;
-    float cs, sn;
-    float r_minus2, r_plus2;
-};
+{
+
+	return in_data->quality == PF_Quality_LO ? static_cast<float>(params[ID_PREVIEW_BUDGET]->u.fs_d.value) : 0.0f;
+
+}
 
 // -------------------------------------------------------------
 
-// PF_Iterate callback for 8-bit pixels
+// Sequence data: which instance a render belongs to
 
 // -------------------------------------------------------------
 
-static PF_Err IteratePix8(void *refcon, A_long x, A_long y, PF_Pixel *in, PF_Pixel *out)
+// Flat (no pointers), so it is saved with the project and copied to MFR
+// render threads as is. A copy keeps the id, so every render of an
+// instance reaches the same PreviewGovernor. A duplicated effect starts
+// out sharing its original's.
+
+struct SepColorSequenceData
 
 {
 
-	const IterateRefcon *rc = reinterpret_cast<const IterateRefcon *>(refcon);
+	A_u_long magic;		// SEQUENCE_DATA_MAGIC
 
-	const float fx = (static_cast<float>(x) - rc->anchor_x) * rc->downsample_x;
+	A_u_long version;	// SEQUENCE_DATA_VERSION
 
-	const float fy = (static_cast<float>(y) - rc->anchor_y) * rc->downsample_y;
+	std::uint64_t instance_id;	// nonzero
 
-	float coverage = 0.0f;
+};
 
-	if (rc->mode == 1)
+static const A_u_long SEQUENCE_DATA_MAGIC = 0x73657163;	// 'seqc'
 
-	{
+static const A_u_long SEQUENCE_DATA_VERSION = 1;
 
-		const float rot_x = fx * rc->cs + fy * rc->sn;
+static std::atomic<std::uint64_t> g_instance_count(0);
 
-		if (rot_x <= -rc->edge_width)
+// Unique across sessions: ids are saved with projects, so a counter that
+// restarts at each launch would collide with ids from earlier sessions
 
-		{
+static std::uint64_t NewInstanceId()
 
-			*out = *in;
+{
 
-			return PF_Err_NONE;
+	std::uint64_t id = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) +
 
-		}
+		0x9E3779B97F4A7C15ull * (g_instance_count.fetch_add(1, std::memory_order_relaxed) + 1);
 
-		if (rot_x >= rc->edge_width)
+	// SplitMix64 finalizer
+	id = (id ^ (id >> 30)) * 0xBF58476D1CE4E5B9ull;
 
-		{
+	id = (id ^ (id >> 27)) * 0x94D049BB133111EBull;
 
-			out->red = rc->color8.red;
+	id ^= id >> 31;
 
-			out->green = rc->color8.green;
+	return id != 0 ? id : 1;
 
-			out->blue = rc->color8.blue;
+}
 
-			out->alpha = in->alpha;
+static bool IsSequenceData(PF_Handle handle)
 
-			return PF_Err_NONE;
+{
 
-		}
+	if (handle == nullptr || g_global_data.handles->host_get_handle_size(handle) < sizeof(SepColorSequenceData))
 
-		const float sd = rot_x * rc->inv_edge_width;
+	{
 
-		coverage = (sd + 1.0f) * 0.5f;
+		return false;
 
 	}
 
-	else
+	const SepColorSequenceData *data = static_cast<const SepColorSequenceData *>(*handle);
+
+	return data->magic == SEQUENCE_DATA_MAGIC && data->version == SEQUENCE_DATA_VERSION && data->instance_id != 0;
+
+}
+
+// New sequence data for `instance_id`, or null when out of memory
+
+static PF_Handle NewSequenceData(std::uint64_t instance_id)
+
+{
+
+	PF_Handle handle = g_global_data.handles->host_new_handle(sizeof(SepColorSequenceData));
+
+	if (handle != nullptr)
 
 	{
 
-		const float dist2 = fx * fx + fy * fy;
+		SepColorSequenceData *data = static_cast<SepColorSequenceData *>(g_global_data.handles->host_lock_handle(handle));
 
-		if (dist2 >= rc->r_plus2)
+		data->magic = SEQUENCE_DATA_MAGIC;
 
-		{
+		data->version = SEQUENCE_DATA_VERSION;
 
-			*out = *in;
+		data->instance_id = instance_id;
 
-			return PF_Err_NONE;
+		g_global_data.handles->host_unlock_handle(handle);
 
-		}
+	}
 
-		if (dist2 <= rc->r_minus2)
+	return handle;
 
-		{
+}
 
-			out->red = rc->color8.red;
+// PF_Cmd_SEQUENCE_SETUP: a new instance
 
-			out->green = rc->color8.green;
+static PF_Err SequenceSetup(PF_InData *in_data, PF_OutData *out_data)
 
-			out->blue = rc->color8.blue;
+{
 
-			out->alpha = in->alpha;
+	(void)in_data;
 
-			return PF_Err_NONE;
+	const std::uint64_t instance_id = NewInstanceId();
 
-		}
+	out_data->sequence_data = NewSequenceData(instance_id);
 
-		const float dist = sqrtf(dist2);
+	if (out_data->sequence_data == nullptr)
 
-		const float sd = (rc->radius - dist) * rc->inv_edge_width;
+	{
 
-		coverage = (sd + 1.0f) * 0.5f;
+		return PF_Err_OUT_OF_MEMORY;
 
 	}
 
-	if (coverage <= Constants::COVERAGE_EPSILON)
+	g_global_data.previews.Acquire(instance_id);
+
+	return PF_Err_NONE;
+
+}
+
+// PF_Cmd_SEQUENCE_RESETUP: loaded from a project, or a copy (MFR render
+// threads included); the data is already flat, so a valid handle is kept
+// as is. Each copy holds a reference on the governor until its setdown.
+
+static PF_Err SequenceResetup(PF_InData *in_data, PF_OutData *out_data)
+
+{
+
+	if (IsSequenceData(in_data->sequence_data))
 
 	{
 
-		*out = *in;
+		out_data->sequence_data = in_data->sequence_data;
+
+		g_global_data.previews.Acquire(static_cast<const SepColorSequenceData *>(*in_data->sequence_data)->instance_id);
 
 		return PF_Err_NONE;
 
 	}
 
-	if (coverage >= Constants::COVERAGE_FULL)
+	if (in_data->sequence_data != nullptr)
 
 	{
 
-		out->red = rc->color8.red;
+		g_global_data.handles->host_dispose_handle(in_data->sequence_data);
+
+	}
+
+	return SequenceSetup(in_data, out_data);
 
-		out->green = rc->color8.green;
+}
 
-		out->blue = rc->color8.blue;
+static PF_Err SequenceSetdown(PF_InData *in_data, PF_OutData *out_data)
 
-		out->alpha = in->alpha;
+{
 
-		return PF_Err_NONE;
+	if (IsSequenceData(in_data->sequence_data))
+
+	{
+
+		g_global_data.previews.Release(static_cast<const SepColorSequenceData *>(*in_data->sequence_data)->instance_id);
 
 	}
 
-	out->red = FastBlend(in->red, rc->color8.red, coverage);
+	if (in_data->sequence_data != nullptr)
+
+	{
 
-	out->green = FastBlend(in->green, rc->color8.green, coverage);
+		g_global_data.handles->host_dispose_handle(in_data->sequence_data);
 
-	out->blue = FastBlend(in->blue, rc->color8.blue, coverage);
+	}
 
-	out->alpha = in->alpha;
+	out_data->sequence_data = nullptr;
 
 	return PF_Err_NONE;
 
 }
 
-static PF_Err Render8Iterate(
+// PF_Cmd_GET_FLATTENED_SEQUENCE_DATA: a copy for an MFR render thread,
+// which must not take over the instance's own handle. Flat data holds no
+// reference; the copy's own resetup takes one
 
-	PF_InData *in_data,
+static PF_Err GetFlattenedSequenceData(PF_InData *in_data, PF_OutData *out_data)
 
-	PF_OutData *out_data,
+{
 
-	PF_ParamDef *params[],
+	const std::uint64_t instance_id = IsSequenceData(in_data->sequence_data) ?
 
-	PF_LayerDef *output,
+		static_cast<const SepColorSequenceData *>(*in_data->sequence_data)->instance_id : NewInstanceId();
 
-	PF_Pixel *input_pixels,
+	out_data->sequence_data = NewSequenceData(instance_id);
 
-	PF_Pixel *output_pixels)
+	return out_data->sequence_data != nullptr ? PF_Err_NONE : PF_Err_OUT_OF_MEMORY;
 
-{
+}
 
-	PF_Err err = PF_Err_NONE;
+// Governor of the rendering instance. Under MFR, in_data->sequence_data
+// must not be read during a render; AE 2022+ hands out a const view
 
-	(void)out_data;
+static SepColor::PreviewGovernor &Governor(const PF_InData *in_data)
 
-	(void)input_pixels;
+{
 
-	(void)output_pixels; // AE passes worlds in iterate call
+	const void *data = nullptr;
 
-	IterateRefcon rc{};
+	if (g_global_data.sequence_data != nullptr)
 
-	rc.width = output->width;
+	{
 
-	rc.height = output->height;
+		PF_ConstHandle handle = nullptr;
 
-	rc.downsample_x = static_cast<float>(in_data->downsample_x.den) / static_cast<float>(in_data->downsample_x.num);
+		if (g_global_data.sequence_data->PF_GetConstSequenceData(in_data->effect_ref, &handle) == PF_Err_NONE && handle != nullptr)
 
-	rc.downsample_y = static_cast<float>(in_data->downsample_y.den) / static_cast<float>(in_data->downsample_y.num);
+		{
 
-	rc.anchor_x = (params[ID_ANCHOR_POINT]->u.td.x_value >> 16);
+			data = *handle;
 
-	rc.anchor_y = (params[ID_ANCHOR_POINT]->u.td.y_value >> 16);
+		}
 
-	rc.angle = static_cast<float>(params[ID_ANGLE]->u.ad.value >> 16) * Constants::DEG_TO_RAD;
+	}
 
-	rc.radius = static_cast<float>(params[ID_RADIUS]->u.fs_d.value);
+	else if (in_data->sequence_data != nullptr)
 
-	rc.mode = params[ID_MODE]->u.pd.value;
+	{
 
-	rc.edge_width = Constants::EDGE_WIDTH;
+		data = *in_data->sequence_data;
 
-	rc.inv_edge_width = 1.0f / rc.edge_width;
+	}
+
+	const SepColorSequenceData *sequence = static_cast<const SepColorSequenceData *>(data);
 
-	rc.color8 = params[ID_COLOR]->u.cd.value;
+	const bool valid = sequence != nullptr && sequence->magic == SEQUENCE_DATA_MAGIC && sequence->version == SEQUENCE_DATA_VERSION;
 
-	// Precompute for speed
+	return g_global_data.previews.Find(valid ? sequence->instance_id : 0);
 
-	rc.cs = cosf(rc.angle);
+}
 
-	rc.sn = sinf(rc.angle);
+static int PreviewLevel(const PF_InData *in_data, PF_ParamDef *params[])
 
-	const float r_minus8 = rc.radius - rc.edge_width;
+{
 
-	const float r_plus8 = rc.radius + rc.edge_width;
+	return PreviewBudget(in_data, params) > 0.0f ? Governor(in_data).Level() : SepColor::PREVIEW_FULL;
 
-	rc.r_minus2 = r_minus8 * r_minus8;
+}
 
-	rc.r_plus2 = r_plus8 * r_plus8;
+// Coverage mode this frame renders with (Antialiasing popup, draft and
+// preview fallbacks)
 
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
+static int CoverageFromParams(const PF_InData *in_data, PF_ParamDef *params[], int preview_level)
 
-	PF_Rect area{0, 0, output->width, output->height};
+{
 
-	if (rc.mode != 1)
+	const int coverage = SepColor::DraftCoverage(params[ID_ANTIALIAS]->u.pd.value - 1, DownsampleX(in_data), DownsampleY(in_data), params[ID_DRAFT]->u.bd.value != 0);
 
-	{
+	return SepColor::PreviewCoverage(coverage, preview_level);
 
-		// Circle mode only affects a bounded region; copy input -> output once
+}
 
-		// so pixels outside the circle keep their original color/alpha.
+static SepColor::Geometry GeometryFromParams(const PF_InData *in_data, PF_ParamDef *params[], int preview_level)
 
-		err = PF_COPY(&params[ID_INPUT]->u.ld, output, nullptr, nullptr);
+{
 
-		if (err != PF_Err_NONE)
+	const float downsample_x = DownsampleX(in_data);
 
-		{
+	const float downsample_y = DownsampleY(in_data);
 
-			return err;
+	// Point and angle params are 16.16 fixed point: keep the fraction, or
+	// the boundary snaps to whole (downsampled) pixels and whole degrees
+	return SepColor::MakeGeometry(
 
-		}
+		params[ID_MODE]->u.pd.value,
 
-		const float ex = (rc.radius + rc.edge_width) / std::max(rc.downsample_x, 1e-6f);
+		FIX_2_FLOAT(params[ID_ANCHOR_POINT]->u.td.x_value),
 
-		const float ey = (rc.radius + rc.edge_width) / std::max(rc.downsample_y, 1e-6f);
+		FIX_2_FLOAT(params[ID_ANCHOR_POINT]->u.td.y_value),
 
-		const int x0 = std::max(0, static_cast<int>(std::floor(rc.anchor_x - ex)));
+		static_cast<float>(FIX_2_FLOAT(params[ID_ANGLE]->u.ad.value)) * Constants::DEG_TO_RAD,
 
-		const int x1 = std::min(rc.width, static_cast<int>(std::ceil(rc.anchor_x + ex)) + 1);
+		static_cast<float>(params[ID_RADIUS]->u.fs_d.value),
 
-		const int y0 = std::max(0, static_cast<int>(std::floor(rc.anchor_y - ey)));
+		downsample_x,
 
-		const int y1 = std::min(rc.height, static_cast<int>(std::ceil(rc.anchor_y + ey)) + 1);
+		downsample_y,
 
-		area.left = x0;
+		CoverageFromParams(in_data, params, preview_level),
 
-		area.right = x1;
+		static_cast<float>(params[ID_EDGE_WIDTH]->u.fs_d.value));
 
-		area.top = y0;
+}
 
-		area.bottom = y1;
+// -------------------------------------------------------------
 
-	}
+// iterate_generic worker shared by all bit depths
 
-	PF_EffectWorld *src = &params[0]->u.ld;
+// -------------------------------------------------------------
 
-	err = suites.Iterate8Suite1()->iterate(
+// Called by the core on thread 0, between slices of its bands and as other
+// workers finish theirs: PF_ABORT for a cancelled render, PF_PROGRESS for
+// the progress bar (which reports a cancel too)
 
-		in_data,
+static int PollHost(void *refcon, int bands_done, int bands_total)
 
-		0,
+{
 
-		output->height,
+	PF_InData *in_data = static_cast<PF_InData *>(refcon);
 
-		src,
+	PF_Err err = PF_ABORT(in_data);
 
-		&area,
+	if (!err)
 
-		&rc,
+	{
 
-		IteratePix8,
+		err = PF_PROGRESS(in_data, bands_done, bands_total);
 
-		output);
+	}
 
 	return err;
 
 }
 
-// PF_Iterate callback for 16-bit pixels
+template<typename PixelType>
 
-static PF_Err IteratePix16(void *refcon, A_long x, A_long y, PF_Pixel16 *in, PF_Pixel16 *out)
+static PF_Err RenderWorker(void *refcon, A_long thread_index, A_long i, A_long iterations)
 
 {
 
-	const IterateRefcon *rc = reinterpret_cast<const IterateRefcon *>(refcon);
+	(void)i;
 
-	const float fx = (static_cast<float>(x) - rc->anchor_x) * rc->downsample_x;
+	(void)iterations;
 
-	const float fy = (static_cast<float>(y) - rc->anchor_y) * rc->downsample_y;
+	// Only the calling thread (index 0) may talk to the host
+	SepColor::RunRenderWorker(*reinterpret_cast<SepColor::RenderJob<PixelType> *>(refcon), thread_index == 0);
 
-	float coverage;
+	return PF_Err_NONE;
 
-	if (rc->mode == 1)
+}
 
-	{
+template<typename PixelType>
 
-		const float rot_x = fx * rc->cs + fy * rc->sn;
+static PF_Err RenderTiles(
 
-		if (rot_x <= -rc->edge_width)
+	PF_InData *in_data,
 
-		{
+	PF_ParamDef *params[],
 
-			*out = *in;
+	PF_EffectWorld *input,
 
-			return PF_Err_NONE;
+	PF_EffectWorld *output,
 
-		}
+	bool smart,
 
-		if (rot_x >= rc->edge_width)
+	int preview_level)
 
-		{
+{
 
-			out->red = rc->r16;
+	SEPCOLOR_ZONE("Render");
 
-			out->green = rc->g16;
+	const auto start = std::chrono::steady_clock::now();
 
-			out->blue = rc->b16;
+	const SepColor::Geometry geom = GeometryFromParams(in_data, params, preview_level);
 
-			out->alpha = in->alpha;
+	PixelType color;
 
-			return PF_Err_NONE;
+	PixelTraits<PixelType>::ConvertColor8(params[ID_COLOR]->u.cd.value, color);
 
-		}
+	// SmartFX worlds carry their position in the layer (origin_x/y), and
+	// the input may extend past the output; PF_Cmd_RENDER worlds both start
+	// at the layer origin
+	const A_long in_x = smart ? input->origin_x : 0;
 
-		const float sd = rot_x * rc->inv_edge_width;
+	const A_long in_y = smart ? input->origin_y : 0;
 
-		coverage = (sd + 1.0f) * 0.5f;
+	const A_long out_x = smart ? output->origin_x : 0;
 
-	}
+	const A_long out_y = smart ? output->origin_y : 0;
 
-	else
+	const A_long left = out_x - in_x;
 
-	{
+	const A_long top = out_y - in_y;
 
-		const float dist2 = fx * fx + fy * fy;
+	if (left < 0 || top < 0 || left + output->width > input->width || top + output->height > input->height)
 
-		if (dist2 >= rc->r_plus2)
+	{
 
-		{
+		// PreRender asks for an output no larger than the input
+		return PF_Err_BAD_CALLBACK_PARAM;
 
-			*out = *in;
+	}
 
-			return PF_Err_NONE;
+	// Copy, fill and band spans are all written by the kernels, so there is
+	// no separate PF_COPY pass, and every output row is touched exactly once.
+	SepColor::RenderJob<PixelType> job(
 
-		}
+		ViewFromWorld<const PixelType>(input, in_x, in_y).SubView(left, top, left + output->width, top + output->height),
 
-		if (dist2 <= rc->r_minus2)
+		ViewFromWorld<PixelType>(output, out_x, out_y),
 
-		{
+		geom,
 
-			out->red = rc->r16;
+		color);
 
-			out->green = rc->g16;
+	job.poll = PollHost;
 
-			out->blue = rc->b16;
+	job.poll_refcon = in_data;
 
-			out->alpha = in->alpha;
+	job.collect_stats = g_global_data.telemetry != nullptr;
 
-			return PF_Err_NONE;
+	const auto setup_end = std::chrono::steady_clock::now();
 
-		}
+	// Nothing on this path allocates: the job and geometry live on this
+	// stack, and each worker keeps its scratch rows on its own
+	PF_Err err = g_global_data.iterate8->iterate_generic(PF_Iterations_ONCE_PER_PROCESSOR, &job, RenderWorker<PixelType>);
 
-		const float dist = sqrtf(dist2);
+	if (!err)
 
-		const float sd = (rc->radius - dist) * rc->inv_edge_width;
+	{
 
-		coverage = (sd + 1.0f) * 0.5f;
+		// PF_Interrupt_CANCEL et al.; AE discards the partial output
+		err = job.status.load(std::memory_order_relaxed);
 
 	}
 
-	if (coverage <= Constants::COVERAGE_EPSILON)
+	if (g_global_data.telemetry != nullptr)
 
 	{
 
-		*out = *in;
+		SepColor::TelemetryRecord record;
 
-		return PF_Err_NONE;
+		record.start_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count());
+
+		record.setup_ms = std::chrono::duration<float, std::milli>(setup_end - start).count();
+
+		record.total_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		SepColor::SetTelemetryStats(record, job.Stats());
+
+		record.width = output->width;
+
+		record.height = output->height;
+
+		record.bitdepth = static_cast<int>(sizeof(PixelType)) * 2;	// 4 channels: bytes per pixel * 8 / 4
+
+		record.mode = geom.mode;
+
+		record.coverage = geom.coverage;
+
+		record.downsample_x = geom.downsample_x;
+
+		record.downsample_y = geom.downsample_y;
+
+		record.status = err;
+
+		g_global_data.telemetry->Push(record);
 
 	}
 
-	if (coverage >= Constants::COVERAGE_FULL)
+	return err;
+
+}
+
+// bitdepth: 8, 16 or 32 (float) bits per channel. Budgeted previews report
+// their render time, which sets the preview level of later frames.
+
+static PF_Err RenderDepth(PF_InData *in_data, PF_ParamDef *params[], PF_EffectWorld *input, PF_EffectWorld *output, int bitdepth, bool smart, int preview_level)
+
+{
+
+	const auto start = std::chrono::steady_clock::now();
+
+	PF_Err err = PF_Err_NONE;
+
+	switch (bitdepth)
 
 	{
 
-		out->red = rc->r16;
+	case 32:
 
-		out->green = rc->g16;
+		err = RenderTiles<PF_PixelFloat>(in_data, params, input, output, smart, preview_level);
 
-		out->blue = rc->b16;
+		break;
 
-		out->alpha = in->alpha;
+	case 16:
 
-		return PF_Err_NONE;
+		err = RenderTiles<PF_Pixel16>(in_data, params, input, output, smart, preview_level);
+
+		break;
+
+	default:
+
+		err = RenderTiles<PF_Pixel>(in_data, params, input, output, smart, preview_level);
+
+		break;
 
 	}
 
-	out->red = FastBlend16(in->red, rc->r16, coverage);
+	const float budget_ms = PreviewBudget(in_data, params);
 
-	out->green = FastBlend16(in->green, rc->g16, coverage);
+	if (!err && budget_ms > 0.0f)
 
-	out->blue = FastBlend16(in->blue, rc->b16, coverage);
+	{
 
-	out->alpha = in->alpha;
+		const float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-	return PF_Err_NONE;
+		Governor(in_data).Report(preview_level, ms, budget_ms);
+
+	}
+
+	return err;
 
 }
 
-static PF_Err Render16Iterate(
+static PF_Err
+
+About(
 
 	PF_InData *in_data,
 
@@ -756,560 +886,582 @@ static PF_Err Render16Iterate(
 
 	PF_ParamDef *params[],
 
-	PF_LayerDef *output,
-
-	PF_Pixel16 *input_pixels,
-
-	PF_Pixel16 *output_pixels)
+	PF_LayerDef *output)
 
 {
 
-	PF_Err err = PF_Err_NONE;
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
 
-	(void)out_data;
+	suites.ANSICallbacksSuite1()->sprintf(
 
-	(void)input_pixels;
+		out_data->return_msg,
 
-	(void)output_pixels;
+		"%s v%d.%d\r%s",
 
-	IterateRefcon rc{};
+		GetStringPtr(StrID_Name),
 
-	rc.width = output->width;
+		MAJOR_VERSION,
 
-	rc.height = output->height;
+		MINOR_VERSION,
 
-	rc.downsample_x = static_cast<float>(in_data->downsample_x.den) / static_cast<float>(in_data->downsample_x.num);
+		GetStringPtr(StrID_Description));
 
-	rc.downsample_y = static_cast<float>(in_data->downsample_y.den) / static_cast<float>(in_data->downsample_y.num);
+	return PF_Err_NONE;
 
-	rc.anchor_x = (params[ID_ANCHOR_POINT]->u.td.x_value >> 16);
+}
 
-	rc.anchor_y = (params[ID_ANCHOR_POINT]->u.td.y_value >> 16);
+static PF_Err
 
-	rc.angle = static_cast<float>(params[ID_ANGLE]->u.ad.value >> 16) * Constants::DEG_TO_RAD;
+GlobalSetup(
 
-	rc.radius = static_cast<float>(params[ID_RADIUS]->u.fs_d.value);
+	PF_InData *in_data,
 
-	rc.mode = params[ID_MODE]->u.pd.value;
+	PF_OutData *out_data,
 
-	rc.edge_width = Constants::EDGE_WIDTH;
+	PF_ParamDef *params[],
 
-	rc.inv_edge_width = 1.0f / rc.edge_width;
+	PF_LayerDef *output)
 
-	rc.color8 = params[ID_COLOR]->u.cd.value;
+{
 
-	// Precompute for speed
+	(void)params;
 
-	rc.cs = cosf(rc.angle);
+	(void)output;
 
-	rc.sn = sinf(rc.angle);
+	PF_Err err = PF_Err_NONE;
 
-	const float r_minus8 = rc.radius - rc.edge_width;
+	out_data->my_version = PF_VERSION(
 
-	const float r_plus8 = rc.radius + rc.edge_width;
+		MAJOR_VERSION,
 
-	rc.r_minus2 = r_minus8 * r_minus8;
+		MINOR_VERSION,
 
-	rc.r_plus2 = r_plus8 * r_plus8;
+		BUG_VERSION,
 
-	rc.r16 = static_cast<A_u_short>((rc.color8.red * Constants::COLOR_SCALE_8_TO_16 + Constants::COLOR_ROUND_OFFSET_16));
+		STAGE_VERSION,
 
-	rc.g16 = static_cast<A_u_short>((rc.color8.green * Constants::COLOR_SCALE_8_TO_16 + Constants::COLOR_ROUND_OFFSET_16));
+		BUILD_VERSION);
 
-	rc.b16 = static_cast<A_u_short>((rc.color8.blue * Constants::COLOR_SCALE_8_TO_16 + Constants::COLOR_ROUND_OFFSET_16));
+	// Deep Color aware: 16-bit support
 
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
+	// PF_OutFlag_DEEP_COLOR_AWARE = 0x02000000
 
-	PF_Rect area{0, 0, output->width, output->height};
+	out_data->out_flags = PF_OutFlag_DEEP_COLOR_AWARE;
 
-	if (rc.mode != 1)
+	// SmartFX, 32-bit float, Multi-Frame Rendering and cache GUID flags
 
-	{
+	// PF_OutFlag2_SUPPORTS_SMART_RENDER = 0x00000400 (PreRender / SmartRender)
 
-		// Circle mode: copy full frame once, then iterate only over the
+	// PF_OutFlag2_FLOAT_COLOR_AWARE = 0x00001000 (32-bit float support, SmartFX only)
 
-		// affected bounding box so alpha outside remains unchanged.
+	// PF_OutFlag2_I_MIX_GUID_DEPENDENCIES = 0x00200000 (PreRender mixes in the fingerprint)
 
-		err = PF_COPY(&params[ID_INPUT]->u.ld, output, nullptr, nullptr);
+	// PF_OutFlag2_SUPPORTS_THREADED_RENDERING = 0x08000000 (MFR support)
 
-		if (err != PF_Err_NONE)
+	// PF_OutFlag2_SUPPORTS_GET_FLATTENED_SEQUENCE_DATA = 0x20000000 (sequence data under MFR)
 
-		{
+	// Must match AE_Effect_Global_OutFlags_2 in the PiPL
 
-			return err;
+	out_data->out_flags2 = PF_OutFlag2_SUPPORTS_SMART_RENDER |
 
-		}
+						   PF_OutFlag2_FLOAT_COLOR_AWARE |
 
-		const float ex = (rc.radius + rc.edge_width) / std::max(rc.downsample_x, 1e-6f);
+						   PF_OutFlag2_I_MIX_GUID_DEPENDENCIES |
 
-		const float ey = (rc.radius + rc.edge_width) / std::max(rc.downsample_y, 1e-6f);
+						   PF_OutFlag2_SUPPORTS_THREADED_RENDERING |
 
-		const int x0 = std::max(0, static_cast<int>(std::floor(rc.anchor_x - ex)));
+						   PF_OutFlag2_SUPPORTS_GET_FLATTENED_SEQUENCE_DATA; // 0x28201400
 
-		const int x1 = std::min(rc.width, static_cast<int>(std::ceil(rc.anchor_x + ex)) + 1);
+	const void *suite = nullptr;
 
-		const int y0 = std::max(0, static_cast<int>(std::floor(rc.anchor_y - ey)));
+	if (in_data->pica_basicP->AcquireSuite(kPFIterate8Suite, kPFIterate8SuiteVersion1, &suite) != kSPNoError || suite == nullptr)
 
-		const int y1 = std::min(rc.height, static_cast<int>(std::ceil(rc.anchor_y + ey)) + 1);
+	{
 
-		area.left = x0;
+		return PF_Err_INVALID_CALLBACK;
 
-		area.right = x1;
+	}
 
-		area.top = y0;
+	g_global_data.iterate8 = static_cast<const PF_Iterate8Suite1 *>(suite);
 
-		area.bottom = y1;
+	if (in_data->pica_basicP->AcquireSuite(kPFHandleSuite, kPFHandleSuiteVersion1, &suite) != kSPNoError || suite == nullptr)
 
-	}
+	{
 
-	PF_EffectWorld *src = &params[0]->u.ld;
+		return PF_Err_INVALID_CALLBACK;
 
-	err = suites.Iterate16Suite1()->iterate(
+	}
 
-		in_data,
+	g_global_data.handles = static_cast<const PF_HandleSuite1 *>(suite);
 
-		0,
+	// Optional: older hosts have no MFR, and in_data->sequence_data is safe
+	// to read during their renders
+	suite = nullptr;
 
-		output->height,
+	if (in_data->pica_basicP->AcquireSuite(kPFEffectSequenceDataSuite, kPFEffectSequenceDataSuiteVersion1, &suite) == kSPNoError && suite != nullptr)
 
-		src,
+	{
 
-		&area,
+		g_global_data.sequence_data = static_cast<const PF_EffectSequenceDataSuite1 *>(suite);
 
-		&rc,
+	}
 
-		IteratePix16,
+	// Pick the fastest kernel ISA: a few ms on the first launch on a
+	// machine, a cache-file read after that
+	g_global_data.simd_isa = SepColor::AutotuneSimdIsa(SepColor::DefaultTuneCachePath());
 
-		output);
+	// Opt-in per-render telemetry, written out at GLOBAL_SETDOWN
+	g_global_data.telemetry = SepColor::OpenTelemetryFromEnv();
 
 	return err;
 
 }
 
-static PF_Err IteratePix32(void *refcon, A_long x, A_long y, PF_PixelFloat *in, PF_PixelFloat *out)
+static PF_Err
 
-{
+GlobalSetdown(
 
-	const IterateRefcon *rc = reinterpret_cast<const IterateRefcon *>(refcon);
+	PF_InData *in_data,
 
-	const float fx = (static_cast<float>(x) - rc->anchor_x) * rc->downsample_x;
+	PF_OutData *out_data,
 
-	const float fy = (static_cast<float>(y) - rc->anchor_y) * rc->downsample_y;
+	PF_ParamDef *params[],
 
-	float coverage;
+	PF_LayerDef *output)
 
-	if (rc->mode == 1)
+{
 
-	{
+	(void)params;
 
-		const float cs = cosf(rc.angle), sn = sinf(rc.angle);
+	(void)output;
+
+	(void)out_data;
+
+	// No render can be in flight any more; drop the suites
+	if (g_global_data.iterate8 != nullptr)
 
-		const float rot_x = fx * cs + fy * sn;
+	{
 
-		const float sd = rot_x * rc->inv_edge_width;
+		in_data->pica_basicP->ReleaseSuite(kPFIterate8Suite, kPFIterate8SuiteVersion1);
 
-		coverage = std::max(0.0f, std::min(1.0f, (sd + 1.0f) * 0.5f));
+		g_global_data.iterate8 = nullptr;
 
 	}
 
-	else
+	if (g_global_data.handles != nullptr)
 
 	{
 
-		const float dist = sqrtf(fx * fx + fy * fy);
-
-		const float sd = (rc->radius - dist) * rc->inv_edge_width;
+		in_data->pica_basicP->ReleaseSuite(kPFHandleSuite, kPFHandleSuiteVersion1);
 
-		coverage = std::max(0.0f, std::min(1.0f, (sd + 1.0f) * 0.5f));
+		g_global_data.handles = nullptr;
 
 	}
 
-	if (coverage <= Constants::COVERAGE_EPSILON)
+	if (g_global_data.sequence_data != nullptr)
 
 	{
 
-		*out = *in;
+		in_data->pica_basicP->ReleaseSuite(kPFEffectSequenceDataSuite, kPFEffectSequenceDataSuiteVersion1);
 
-		return PF_Err_NONE;
+		g_global_data.sequence_data = nullptr;
 
 	}
 
-	const float r = static_cast<float>(rc->color8.red) * Constants::COLOR_SCALE_8_TO_FLOAT;
-
-	const float g = static_cast<float>(rc->color8.green) * Constants::COLOR_SCALE_8_TO_FLOAT;
-
-	const float b = static_cast<float>(rc->color8.blue) * Constants::COLOR_SCALE_8_TO_FLOAT;
-
-	if (coverage >= Constants::COVERAGE_FULL)
+	if (g_global_data.telemetry != nullptr)
 
 	{
 
-		out->red = r;
+		g_global_data.telemetry->Flush();
 
-		out->green = g;
+		delete g_global_data.telemetry;
 
-		out->blue = b;
+		g_global_data.telemetry = nullptr;
 
-		out->alpha = in->alpha;
+	}
 
-		return PF_Err_NONE;
+#if SEPCOLOR_TRACE
 
-	}
+	// Trace builds only: the session's zones as Chrome trace-event JSON
+	const std::string trace_path = SepColor::detail::GetEnv("SEP_COLOR_TRACE");
+
+	if (!trace_path.empty())
 
-	out->red = FastBlendFloat(in->red, r, coverage);
+	{
 
-	out->green = FastBlendFloat(in->green, g, coverage);
+		SepColor::trace::WriteChromeTrace(trace_path);
 
-	out->blue = FastBlendFloat(in->blue, b, coverage);
+	}
 
-	out->alpha = in->alpha;
+#endif
 
 	return PF_Err_NONE;
 
 }
 
-static PF_Err Render32Iterate(
+static PF_Err ParamsSetup(PF_InData *in_data, PF_OutData *out_data, PF_ParamDef *params[], PF_LayerDef *output)
 
-	PF_InData *in_data,
+{
 
-	PF_OutData *out_data,
+	PF_Err err = PF_Err_NONE;
 
-	PF_ParamDef *params[],
+	PF_ParamDef def;
 
-	PF_LayerDef *output,
+	AEFX_CLR_STRUCT(def);
 
-	PF_PixelFloat *input_pixels,
+	PF_ADD_POINT("Anchor Point",
 
-	PF_PixelFloat *output_pixels)
+				 50, 50,
 
-{
+				 false,
 
-	PF_Err err = PF_Err_NONE;
+				 ID_ANCHOR_POINT);
 
-	(void)out_data;
+	PF_ADD_POPUP("Mode",
 
-	(void)input_pixels;
+				 2,				// Number of options
 
-	(void)output_pixels;
+				 1,				// Default selection (1: Line, 2: Circle)
 
-	IterateRefcon rc{};
+				 "Line|Circle", // Options
 
-	rc.width = output->width;
+				 ID_MODE);
 
-	rc.height = output->height;
+	// Anti-aliasing is always ON, removed from UI
 
-	rc.downsample_x = static_cast<float>(in_data->downsample_x.den) / static_cast<float>(in_data->downsample_x.num);
+	PF_ADD_ANGLE("Angle", 0, ID_ANGLE);
 
-	rc.downsample_y = static_cast<float>(in_data->downsample_y.den) / static_cast<float>(in_data->downsample_y.num);
+	PF_ADD_FLOAT_SLIDERX(
 
-	rc.anchor_x = (params[ID_ANCHOR_POINT]->u.td.x_value >> 16);
+		"Radius",
 
-	rc.anchor_y = (params[ID_ANCHOR_POINT]->u.td.y_value >> 16);
+		0,
 
-	rc.angle = static_cast<float>(params[ID_ANGLE]->u.ad.value >> 16) * Constants::DEG_TO_RAD;
+		3000,
 
-	rc.radius = static_cast<float>(params[ID_RADIUS]->u.fs_d.value);
+		0,
 
-	rc.mode = params[ID_MODE]->u.pd.value;
+		500,
 
-	rc.edge_width = Constants::EDGE_WIDTH;
+		100,
 
-	rc.inv_edge_width = 1.0f / rc.edge_width;
+		PF_Precision_INTEGER,
 
-	rc.color8 = params[ID_COLOR]->u.cd.value;
+		0,
 
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
+		0,
 
-	PF_Rect area{0, 0, output->width, output->height};
+		ID_RADIUS);
 
-	if (rc.mode != 1)
+	PF_ADD_COLOR("Color", 255, 0, 0, ID_COLOR);
 
-	{
+	PF_ADD_POPUP("Antialiasing",
 
-		// Circle mode: copy full frame once, then iterate only over the
+				 6,						// Number of options
 
-		// affected bounding box so alpha outside remains unchanged.
+				 1,						// Default selection (1: Linear, 2: Exact Area, 3+: filter profiles)
 
-		err = PF_COPY(&params[ID_INPUT]->u.ld, output, nullptr, nullptr);
+				 "Linear|Exact Area|Box|Tent|Gaussian|Smoothstep",	// Options
 
-		if (err != PF_Err_NONE)
+				 ID_ANTIALIAS);
 
-		{
+	// Full support of the Box/Tent/Gaussian/Smoothstep profile in pixels
 
-			return err;
+	PF_ADD_FLOAT_SLIDERX(
 
-		}
+		"Edge Width",
 
-		const float ex = (rc.radius + rc.edge_width) / std::max(rc.downsample_x, 1e-6f);
+		0.1,
 
-		const float ey = (rc.radius + rc.edge_width) / std::max(rc.downsample_y, 1e-6f);
+		200,
 
-		const int x0 = std::max(0, static_cast<int>(std::floor(rc.anchor_x - ex)));
+		0.5,
 
-		const int x1 = std::min(rc.width, static_cast<int>(std::ceil(rc.anchor_x + ex)) + 1);
+		20,
 
-		const int y0 = std::max(0, static_cast<int>(std::floor(rc.anchor_y - ey)));
+		1,
 
-		const int y1 = std::min(rc.height, static_cast<int>(std::ceil(rc.anchor_y + ey)) + 1);
+		PF_Precision_TENTHS,
 
-		area.left = x0;
+		0,
 
-		area.right = x1;
+		0,
 
-		area.top = y0;
+		ID_EDGE_WIDTH);
 
-		area.bottom = y1;
+	// Previews at 1/2 resolution and below are always drafted; this forces
+	// draft coverage at full resolution as well (interactive playback)
+	PF_ADD_CHECKBOX("Draft Quality",
 
-	}
+					"Fast coverage",
 
-	PF_EffectWorld *src = &params[0]->u.ld;
+					FALSE,
 
-	err = suites.IterateFloatSuite1()->iterate(
+					0,
 
-		in_data,
+					ID_DRAFT);
 
-		0,
+	// PF_Quality_LO renders step coverage down (Linear, then hard edge)
+	// while they overrun this many ms per frame; 0 keeps full quality
+	PF_ADD_FLOAT_SLIDERX(
 
-		output->height,
+		"Preview Budget (ms)",
 
-		src,
+		0,
 
-		&area,
+		1000,
 
-		&rc,
+		0,
 
-		IteratePix32,
+		100,
 
-		output);
+		0,
 
-	return err;
+		PF_Precision_INTEGER,
 
-}
+		0,
 
-static PF_Err
+		0,
 
-About(
+		ID_PREVIEW_BUDGET);
 
-	PF_InData *in_data,
+	out_data->num_params = SKELETON_NUM_PARAMS;
 
-	PF_OutData *out_data,
+	return PF_Err_NONE;
 
-	PF_ParamDef *params[],
+}
 
-	PF_LayerDef *output)
+// Non-SmartFX render (PF_Cmd_RENDER) with bit-depth detection, for hosts
+// without SmartFX; After Effects calls PreRender / SmartRender instead.
+// Always renders on AE's own worker threads (iterate_generic) for MFR safety
+
+static PF_Err Render(PF_InData *in_data, PF_OutData *out_data, PF_ParamDef *params[], PF_LayerDef *output)
 
 {
 
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
+	PF_Err err = PF_Err_NONE;
 
-	suites.ANSICallbacksSuite1()->sprintf(
+	(void)out_data;
 
-		out_data->return_msg,
+	// Determine bit depth using SDK-standard approach
+	// Priority: 32-bit float -> 16-bit -> 8-bit
 
-		"%s v%d.%d\r%s",
+	bool is_32bit_float = false;
 
-		GetStringPtr(StrID_Name),
+	// Check world_flags for 32-bit float (PF_OutFlag2_FLOAT_COLOR_AWARE)
+	// PF_WORLD_IS_DEEP checks for 16-bit, so if it's not deep but world_flags indicate float
+	if (!PF_WORLD_IS_DEEP(output))
 
-		MAJOR_VERSION,
+	{
+		// Check world_flags for 32-bit float format
+		// output->world_flags & PF_WorldFlag_FLOAT indicates 32-bit float
+		is_32bit_float = (output->world_flags & PF_WorldFlag_FLOAT) != 0;
+	}
 
-		MINOR_VERSION,
+	const int bitdepth = is_32bit_float ? 32 : (PF_WORLD_IS_DEEP(output) ? 16 : 8);
 
-		GetStringPtr(StrID_Description));
+	err = RenderDepth(in_data, params, &params[ID_INPUT]->u.ld, output, bitdepth, false, PreviewLevel(in_data, params));
 
-	return PF_Err_NONE;
+	return err;
 
 }
 
-static PF_Err
+// -------------------------------------------------------------
 
-GlobalSetup(
+// SmartFX: PF_Cmd_SMART_PRE_RENDER / PF_Cmd_SMART_RENDER
 
-	PF_InData *in_data,
+// -------------------------------------------------------------
 
-	PF_OutData *out_data,
+// SmartFX commands get no params[]; check the effect's own params out at
+// the current time into defs, with params[] pointing at them as in
+// PF_Cmd_RENDER. Entries stay null until checked out.
 
-	PF_ParamDef *params[],
-
-	PF_LayerDef *output)
+static PF_Err CheckoutParams(PF_InData *in_data, PF_ParamDef defs[], PF_ParamDef *params[])
 
 {
 
-	(void)params;
-
-	(void)output;
-
 	PF_Err err = PF_Err_NONE;
 
-	out_data->my_version = PF_VERSION(
-
-		MAJOR_VERSION,
+	for (A_long id = 0; id < SKELETON_NUM_PARAMS; ++id)
 
-		MINOR_VERSION,
+	{
 
-		BUG_VERSION,
+		params[id] = nullptr;
 
-		STAGE_VERSION,
+	}
 
-		BUILD_VERSION);
+	for (A_long id = ID_INPUT + 1; id < SKELETON_NUM_PARAMS && !err; ++id)
 
-	// Deep Color aware: 16-bit support
+	{
 
-	// PF_OutFlag_DEEP_COLOR_AWARE = 0x02000000
+		AEFX_CLR_STRUCT(defs[id]);
 
-	out_data->out_flags = PF_OutFlag_DEEP_COLOR_AWARE;
+		err = PF_CHECKOUT_PARAM(in_data, id, in_data->current_time, in_data->time_step, in_data->time_scale, &defs[id]);
 
-	// 32-bit float support and Multi-Frame Rendering support flags
+		if (!err)
 
-	// PF_OutFlag2_FLOAT_COLOR_AWARE = 0x00000001 (32-bit float support)
+		{
 
-	// PF_OutFlag2_SUPPORTS_THREADED_RENDERING = 0x08000000 (MFR support)
+			params[id] = &defs[id];
 
-	// Setting both enables 32-bit float projects without warnings
+		}
 
-	out_data->out_flags2 = 0x08000001; // PF_OutFlag2_SUPPORTS_THREADED_RENDERING | PF_OutFlag2_FLOAT_COLOR_AWARE
+	}
 
 	return err;
 
 }
 
-static PF_Err
+static PF_Err CheckinParams(PF_InData *in_data, PF_ParamDef *params[])
 
-GlobalSetdown(
+{
 
-	PF_InData *in_data,
+	PF_Err err = PF_Err_NONE;
 
-	PF_OutData *out_data,
+	for (A_long id = ID_INPUT + 1; id < SKELETON_NUM_PARAMS; ++id)
 
-	PF_ParamDef *params[],
+	{
 
-	PF_LayerDef *output)
+		if (params[id] != nullptr)
 
-{
+		{
 
-	(void)params;
+			const PF_Err checkin_err = PF_CHECKIN_PARAM(in_data, params[id]);
 
-	(void)output;
+			err = err ? err : checkin_err;
 
-	(void)in_data;
+		}
 
-	(void)out_data;
+	}
 
-	return PF_Err_NONE;
+	return err;
 
 }
 
-static PF_Err ParamsSetup(PF_InData *in_data, PF_OutData *out_data, PF_ParamDef *params[], PF_LayerDef *output)
+// The output covers exactly the input's pixels (transparent input stays
+// transparent). The cache fingerprint is mixed into AE's frame GUID, so
+// cached frames survive sessions and only go stale when it changes.
+// The preview level is fixed here, so the GUID and the pixels agree, and
+// handed to SmartRender in pre_render_data (a small int, nothing to free).
+
+static PF_Err PreRender(PF_InData *in_data, PF_OutData *out_data, PF_PreRenderExtra *extra)
 
 {
 
-	PF_Err err = PF_Err_NONE;
+	SEPCOLOR_ZONE("PreRender");
 
-	PF_ParamDef def;
+	(void)out_data;
 
-	AEFX_CLR_STRUCT(def);
+	PF_ParamDef defs[SKELETON_NUM_PARAMS];
 
-	PF_ADD_POINT("Anchor Point",
+	PF_ParamDef *params[SKELETON_NUM_PARAMS];
 
-				 50, 50,
+	PF_Err err = CheckoutParams(in_data, defs, params);
 
-				 false,
+	if (!err)
 
-				 ID_ANCHOR_POINT);
+	{
 
-	PF_ADD_POPUP("Mode",
+		// Parameter values, time and downsample are AE's part of the key;
+		// ours is the state behind them (see SepColor::RenderFingerprint)
+		const int preview_level = PreviewLevel(in_data, params);
 
-				 2,				// Number of options
+		const std::uint64_t fingerprint = SepColor::RenderFingerprint(CoverageFromParams(in_data, params, preview_level));
 
-				 1,				// Default selection (1: Line, 2: Circle)
-
-				 "Line|Circle", // Options
+		err = extra->cb->GuidMixInPtr(in_data->effect_ref, static_cast<A_u_long>(sizeof(fingerprint)), &fingerprint);
 
-				 ID_MODE);
+		extra->output->pre_render_data = reinterpret_cast<void *>(static_cast<std::intptr_t>(preview_level));
 
-	// Anti-aliasing is always ON, removed from UI
+	}
 
-	PF_ADD_ANGLE("Angle", 0, ID_ANGLE);
+	if (!err)
 
-	PF_ADD_FLOAT_SLIDERX(
+	{
 
-		"Radius",
+		PF_RenderRequest request = extra->input->output_request;
 
-		0,
+		PF_CheckoutResult in_result;
 
-		3000,
+		AEFX_CLR_STRUCT(in_result);
 
-		0,
+		err = extra->cb->checkout_layer(in_data->effect_ref, ID_INPUT, ID_INPUT, &request, in_data->current_time, in_data->time_step, in_data->time_scale, &in_result);
 
-		500,
+		if (!err)
 
-		100,
-
-		PF_Precision_INTEGER,
+		{
 
-		0,
+			extra->output->result_rect = in_result.result_rect;
 
-		0,
+			extra->output->max_result_rect = in_result.max_result_rect;
 
-		ID_RADIUS);
+		}
 
-	PF_ADD_COLOR("Color", 255, 0, 0, ID_COLOR);
+	}
 
-	out_data->num_params = SKELETON_NUM_PARAMS;
+	const PF_Err checkin_err = CheckinParams(in_data, params);
 
-	return PF_Err_NONE;
+	return err ? err : checkin_err;
 
 }
 
-// Main render function with bit-depth detection
-// Always uses PF_Iterate suites for MFR-safe threading
-
-static PF_Err Render(PF_InData *in_data, PF_OutData *out_data, PF_ParamDef *params[], PF_LayerDef *output)
+static PF_Err SmartRender(PF_InData *in_data, PF_OutData *out_data, PF_SmartRenderExtra *extra)
 
 {
 
-	PF_Err err = PF_Err_NONE;
+	SEPCOLOR_ZONE("SmartRender");
 
 	(void)out_data;
 
-	// Determine bit depth using SDK-standard approach
-	// Priority: 32-bit float -> 16-bit -> 8-bit
+	PF_ParamDef defs[SKELETON_NUM_PARAMS];
 
-	bool is_32bit_float = false;
+	PF_ParamDef *params[SKELETON_NUM_PARAMS];
 
-	// Check world_flags for 32-bit float (PF_OutFlag2_FLOAT_COLOR_AWARE)
-	// PF_WORLD_IS_DEEP checks for 16-bit, so if it's not deep but world_flags indicate float
-	if (!PF_WORLD_IS_DEEP(output))
+	PF_EffectWorld *input = nullptr;
+
+	PF_EffectWorld *output = nullptr;
+
+	PF_Err err = CheckoutParams(in_data, defs, params);
+
+	if (!err)
 
 	{
-		// Check world_flags for 32-bit float format
-		// output->world_flags & PF_WorldFlag_FLOAT indicates 32-bit float
-		is_32bit_float = (output->world_flags & PF_WorldFlag_FLOAT) != 0;
+
+		err = extra->cb->checkout_layer_pixels(in_data->effect_ref, ID_INPUT, &input);
+
 	}
 
-	if (is_32bit_float)
+	if (!err)
 
 	{
-		// 32-bit float rendering - always use PF_Iterate suite (MFR-safe)
-		err = Render32Iterate(in_data, out_data, params, output, nullptr, nullptr);
+
+		err = extra->cb->checkout_output(in_data->effect_ref, &output);
+
 	}
 
-	// 16-bit detection
-	else if (PF_WORLD_IS_DEEP(output))
+	// An empty request (layer off-screen) checks out no worlds
+	if (!err && input != nullptr && output != nullptr)
 
 	{
-		// 16-bit rendering - always use PF_Iterate suite (MFR-safe)
-		err = Render16Iterate(in_data, out_data, params, output, nullptr, nullptr);
+
+		const int preview_level = static_cast<int>(reinterpret_cast<std::intptr_t>(extra->input->pre_render_data));
+
+		err = RenderDepth(in_data, params, input, output, extra->input->bitdepth, true, preview_level);
+
 	}
 
-	// 8-bit rendering (default)
-	else
+	if (input != nullptr)
 
 	{
-		// 8-bit rendering - always use PF_Iterate suite (MFR-safe)
-		err = Render8Iterate(in_data, out_data, params, output, nullptr, nullptr);
+
+		const PF_Err checkin_err = extra->cb->checkin_layer_pixels(in_data->effect_ref, ID_INPUT);
+
+		err = err ? err : checkin_err;
+
 	}
 
-	return err;
+	const PF_Err checkin_err = CheckinParams(in_data, params);
+
+	return err ? err : checkin_err;
 
 }
 
@@ -1413,12 +1565,48 @@ extern "C"
 
 				break;
 
+			case PF_Cmd_SEQUENCE_SETUP:
+
+				err = SequenceSetup(in_data, out_data);
+
+				break;
+
+			case PF_Cmd_SEQUENCE_RESETUP:
+
+				err = SequenceResetup(in_data, out_data);
+
+				break;
+
+			case PF_Cmd_SEQUENCE_SETDOWN:
+
+				err = SequenceSetdown(in_data, out_data);
+
+				break;
+
+			case PF_Cmd_GET_FLATTENED_SEQUENCE_DATA:
+
+				err = GetFlattenedSequenceData(in_data, out_data);
+
+				break;
+
 			case PF_Cmd_RENDER:
 
 				err = Render(in_data, out_data, params, output);
 
 				break;
 
+			case PF_Cmd_SMART_PRE_RENDER:
+
+				err = PreRender(in_data, out_data, static_cast<PF_PreRenderExtra *>(extra));
+
+				break;
+
+			case PF_Cmd_SMART_RENDER:
+
+				err = SmartRender(in_data, out_data, static_cast<PF_SmartRenderExtra *>(extra));
+
+				break;
+
 			}
 
 		}
@@ -28,6 +28,7 @@ typedef unsigned short PixelType;
 #include "AE_Macros.h"
 #include "Param_Utils.h"
 #include "AE_EffectCBSuites.h"
+#include "AE_EffectSuites.h"
 #include "String_Utils.h"
 #include "AE_GeneralPlug.h"
 #include "AEFX_ChannelDepthTpl.h"
@@ -37,11 +38,7 @@ typedef unsigned short PixelType;
 
 /* Versioning information */
 
-#define MAJOR_VERSION 1
-#define MINOR_VERSION 1
-#define BUG_VERSION 0
-#define STAGE_VERSION PF_Stage_DEVELOP
-#define BUILD_VERSION 1
+#include "sep_color_Version.h"
 
 // Parameter IDs (match sep_color.cpp usage)
 enum
@@ -52,6 +49,10 @@ enum
 	ID_ANGLE,		   // 3: Angle
 	ID_RADIUS,		   // 4: Radius
 	ID_COLOR,		   // 5: Color
+	ID_ANTIALIAS,	   // 6: Popup Linear|Exact Area|Box|Tent|Gaussian|Smoothstep
+	ID_EDGE_WIDTH,	   // 7: Edge Width (filter profiles only)
+	ID_DRAFT,		   // 8: Draft Quality checkbox (draft coverage at any resolution)
+	ID_PREVIEW_BUDGET, // 9: Preview Budget (ms) for PF_Quality_LO renders, 0 = off
 	SKELETON_NUM_PARAMS // total count
 };
 
@@ -59,7 +59,7 @@ resource 'PiPL' (16000) {
 			0x02000000 // PF_OutFlag_DEEP_COLOR_AWARE
 		},
 		AE_Effect_Global_OutFlags_2 {
-			0x08000001 // PF_OutFlag2_SUPPORTS_THREADED_RENDERING | PF_OutFlag2_FLOAT_COLOR_AWARE
+			0x28201400 // PF_OutFlag2_SUPPORTS_GET_FLATTENED_SEQUENCE_DATA | PF_OutFlag2_SUPPORTS_THREADED_RENDERING | PF_OutFlag2_I_MIX_GUID_DEPENDENCIES | PF_OutFlag2_FLOAT_COLOR_AWARE | PF_OutFlag2_SUPPORTS_SMART_RENDER
 		},
 		AE_Effect_OutFlags {
 			0
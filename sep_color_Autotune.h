@@ -0,0 +1,351 @@
+#pragma once
+
+#ifndef SEP_COLOR_AUTOTUNE_H
+#define SEP_COLOR_AUTOTUNE_H
+
+// Startup kernel selection for the sep_color core.
+// The widest ISA is not always the fastest: AVX-512 can lower the clock of
+// the whole core, and on some parts AVX2 or SSE4.1 wins on the short band
+// runs this effect produces. AutotuneSimdIsa() times the band kernels
+// of every ISA the CPU supports on synthetic band rows (about 0.1 s), keeps
+// the fastest and caches the decision on disk, keyed by CPU model and
+// TUNE_VERSION, so later launches skip the timing. Every ISA gives the
+// same bits, so the choice only ever affects speed, never the picture.
+//
+// Call once per process before rendering (AE: PF_Cmd_GLOBAL_SETUP).
+
+#include "sep_color_Core.h"
+
+#include "sep_color_Platform.h"
+
+#include <algorithm>
+
+#include <chrono>
+
+#include <cstdint>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <cstring>
+
+#include <string>
+
+#include <vector>
+
+#if defined(SEPCOLOR_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SEPCOLOR_SIMD_X86)
+#include <cpuid.h>
+#endif
+
+namespace SepColor {
+
+// Bump whenever the kernels change enough to invalidate cached timings
+constexpr int TUNE_VERSION = 2;
+
+namespace detail {
+
+// CPU brand string (x86), or just the compile target elsewhere
+inline std::string CpuModel()
+
+{
+#if defined(SEPCOLOR_SIMD_X86)
+	unsigned int regs[12] = {};
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0x80000000);
+	if (static_cast<unsigned int>(info[0]) >= 0x80000004u)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			__cpuid(info, 0x80000002 + i);
+			for (int r = 0; r < 4; ++r)
+			{
+				regs[i * 4 + r] = static_cast<unsigned int>(info[r]);
+			}
+		}
+	}
+#else
+	if (__get_cpuid_max(0x80000000u, nullptr) >= 0x80000004u)
+	{
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			__get_cpuid(0x80000002u + i, &regs[i * 4], &regs[i * 4 + 1], &regs[i * 4 + 2], &regs[i * 4 + 3]);
+		}
+	}
+#endif
+	char brand[sizeof(regs) + 1] = {};
+	std::memcpy(brand, regs, sizeof(regs));
+	std::string model(brand);
+	for (char &c : model)
+	{
+		c = (c == '\n' || c == '\r') ? ' ' : c;
+	}
+	return model.empty() ? std::string("x86") : model;
+#elif defined(SEPCOLOR_SIMD_NEON)
+	return "arm64";
+#else
+	return "generic";
+#endif
+}
+
+// 8-bit pixel of the timing rows; the most common depth in hosts
+struct TunePixel
+{
+	std::uint8_t alpha, red, green, blue;
+};
+
+} // namespace detail
+
+template<>
+
+struct PixelTraits<detail::TunePixel>
+
+{
+
+	using ChannelType = std::uint8_t;
+
+	using PixelType = detail::TunePixel;
+
+	static constexpr bool IsFloat = false;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return BlendFixed(src, dst, QuantizeCoverage(coverage));
+
+	}
+
+};
+
+namespace detail {
+
+/**
+ * Time the band kernels of one ISA: coverage plus shading of rows across
+ * the AA band, as band spans do (an Exact Area line almost parallel to the
+ * rows, and the rim of a large circle). One warm-up pass, then the median
+ * of PASSES timed passes of a few ms each, well above the clock's noise.
+ */
+
+inline double TimeSimdIsa(SimdIsa isa)
+
+{
+
+	constexpr int ROWS = 512;
+
+	constexpr int PASSES = 9;
+
+	const Geometry shapes[2] = {
+
+		MakeGeometry(MODE_LINE, 0.0, 0.0, 1.5688f, 0.0f, 1.0f, 1.0f, COVERAGE_AREA),
+
+		MakeGeometry(MODE_CIRCLE, 0.0, 20000.0, 0.0f, 20000.0f, 1.0f, 1.0f, COVERAGE_AREA)
+
+	};
+
+	SetSimdIsa(isa);
+
+	RowScratch scratch;
+
+	std::vector<TunePixel> in(RowScratch::CAPACITY), out(RowScratch::CAPACITY);
+
+	for (int x = 0; x < RowScratch::CAPACITY; ++x)
+
+	{
+
+		in[x] = TunePixel{ 255, static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(x * 3), static_cast<std::uint8_t>(x * 7) };
+
+	}
+
+	const TunePixel color = { 255, 255, 10, 200 };
+
+	double times[PASSES];
+
+	volatile std::uint8_t sink = 0;	// keeps the kernel calls observable
+
+	for (int pass = -1; pass < PASSES; ++pass)
+
+	{
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (const Geometry &g : shapes)
+
+		{
+
+			for (int row = 0; row < ROWS; ++row)
+
+			{
+
+				CoverageRun(g, row - ROWS / 2, -RowScratch::CAPACITY / 2, RowScratch::CAPACITY / 2, scratch.coverage);
+
+				ShadeRun(in.data(), out.data(), color, scratch, RowScratch::CAPACITY);
+
+				sink = sink + out[row % RowScratch::CAPACITY].red;
+
+			}
+
+		}
+
+		const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (pass >= 0)	// pass -1 warms caches and wakes the vector units
+
+		{
+
+			times[pass] = elapsed;
+
+		}
+
+	}
+
+	std::nth_element(times, times + PASSES / 2, times + PASSES);
+
+	return times[PASSES / 2];
+
+}
+
+} // namespace detail
+
+/**
+ * Fastest ISA on this machine, measured now. Leaves it selected.
+ */
+
+inline SimdIsa CalibrateSimdIsa()
+
+{
+
+	const SimdIsa widest = DetectSimdIsa();
+
+	SimdIsa winner = SIMD_SCALAR;
+
+	double winner_time = detail::TimeSimdIsa(SIMD_SCALAR);
+
+	for (int isa = SIMD_SCALAR + 1; isa <= SIMD_NEON; ++isa)
+
+	{
+
+		// SetSimdIsa() clamps what the CPU lacks; skip those repeats
+		const bool supported = widest == SIMD_NEON ? isa == SIMD_NEON : (isa != SIMD_NEON && isa <= widest);
+
+		if (!supported)
+
+		{
+
+			continue;
+
+		}
+
+		const double t = detail::TimeSimdIsa(static_cast<SimdIsa>(isa));
+
+		if (t < winner_time)
+
+		{
+
+			winner = static_cast<SimdIsa>(isa);
+
+			winner_time = t;
+
+		}
+
+	}
+
+	return SetSimdIsa(winner);
+
+}
+
+/**
+ * Per-user cache file for the tuning result, or "" when no home / cache
+ * directory is known (the tuner then just calibrates every launch).
+ */
+
+inline std::string DefaultTuneCachePath()
+
+{
+#if defined(_WIN32)
+	const std::string dir = detail::GetEnv("LOCALAPPDATA");
+	return dir.empty() ? std::string() : dir + "\\sep_color_tune.txt";
+#elif defined(__APPLE__)
+	const std::string home = detail::GetEnv("HOME");
+	return home.empty() ? std::string() : home + "/Library/Caches/sep_color_tune.txt";
+#else
+	const std::string xdg = detail::GetEnv("XDG_CACHE_HOME");
+	if (!xdg.empty())
+	{
+		return xdg + "/sep_color_tune.txt";
+	}
+	const std::string home = detail::GetEnv("HOME");
+	return home.empty() ? std::string() : home + "/.cache/sep_color_tune.txt";
+#endif
+}
+
+/**
+ * Select the kernel ISA: the cached winner when `cache_path` holds one for
+ * this CPU and TUNE_VERSION, otherwise calibrate and write the cache.
+ * Never fails; an unreadable or unwritable cache only costs the timing.
+ */
+
+inline SimdIsa AutotuneSimdIsa(const std::string &cache_path)
+
+{
+
+	const std::string key = "sep_color tune " + std::to_string(TUNE_VERSION) + " " + detail::CpuModel();
+
+	if (!cache_path.empty())
+
+	{
+
+		if (std::FILE *file = detail::OpenFile(cache_path, "r"))
+
+		{
+
+			char line[256] = {};
+
+			int isa = -1;
+
+			const bool hit = std::fgets(line, sizeof(line), file) != nullptr && key + "\n" == line &&
+
+				std::fscanf(file, "%d", &isa) == 1 && isa >= SIMD_SCALAR && isa <= SIMD_NEON;
+
+			std::fclose(file);
+
+			if (hit)
+
+			{
+
+				return SetSimdIsa(static_cast<SimdIsa>(isa));
+
+			}
+
+		}
+
+	}
+
+	const SimdIsa winner = CalibrateSimdIsa();
+
+	if (!cache_path.empty())
+
+	{
+
+		if (std::FILE *file = detail::OpenFile(cache_path, "w"))
+
+		{
+
+			std::fprintf(file, "%s\n%d\n", key.c_str(), static_cast<int>(winner));
+
+			std::fclose(file);
+
+		}
+
+	}
+
+	return winner;
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_AUTOTUNE_H
@@ -0,0 +1,1758 @@
+#pragma once
+
+#ifndef SEP_COLOR_CORE_H
+#define SEP_COLOR_CORE_H
+
+// SDK-independent rendering core for sep_color.
+// Nothing in this header includes After Effects headers: pixel formats are
+// plugged in through PixelTraits<T> specializations supplied by the host glue
+// (sep_color.cpp for AE), so the same kernels can run on any buffer.
+
+#include <algorithm>
+
+#include <chrono>
+
+#include <cmath>
+
+#include <cstddef>
+
+#include <cstdint>
+
+#include <cstring>
+
+#include <type_traits>
+
+#include "sep_color_Simd.h"
+
+#include "sep_color_Trace.h"
+
+/**
+ * Determinism: a frame must hash the same on every machine and thread count,
+ * so the core never lets the compiler fuse a*b+c into an FMA (x86 with
+ * -mfma and ARM64 would otherwise round coverage differently). MSVC and
+ * clang are told here; GCC builds must pass -ffp-contract=off. Fast-math
+ * style flags (/fp:fast, -ffast-math) are not supported for the same reason.
+ *
+ * 8/16-bit outputs are then bit-exact everywhere: coverage is quantized to
+ * COVERAGE_BITS and blended in integer arithmetic. Float outputs use the same
+ * operation order on every path and stay within FLOAT_OUTPUT_TOLERANCE of
+ * each other (equal in practice on IEEE hardware without contraction).
+ */
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+// Named constants for magic numbers
+
+namespace Constants {
+
+	// Mathematical constants
+
+	constexpr float PI = 3.14159265358979323846f;              // Pi constant
+
+	constexpr float INV_SQRT_2 = 0.70710678118654752440f;       // 1/sqrt(2) for edge width
+
+	constexpr float EDGE_WIDTH = INV_SQRT_2;                   // Anti-aliasing edge width (1/sqrt(2))
+
+	// Coverage thresholds for early-outs
+
+	constexpr float COVERAGE_EPSILON = 0.0001f;                // Below this: skip blending (use input)
+
+	constexpr float COVERAGE_FULL = 0.9999f;                   // Above this: full coverage (use effect color)
+
+	// Angle conversion
+
+	constexpr float DEG_TO_RAD = PI / 180.0f;                  // Degrees to radians conversion
+
+	// Color conversion constants
+
+	constexpr float COLOR_8BIT_MAX = 255.0f;                   // 8-bit color maximum
+
+	constexpr float COLOR_16BIT_MAX = 32768.0f;                // 16-bit color maximum
+
+	constexpr float COLOR_SCALE_8_TO_16 = COLOR_16BIT_MAX / COLOR_8BIT_MAX;  // 32768/255
+
+	constexpr float COLOR_SCALE_8_TO_FLOAT = 1.0f / COLOR_8BIT_MAX;          // 1/255
+
+	constexpr float COLOR_ROUND_OFFSET_16 = 127.0f;            // Rounding offset for 16-bit conversion
+
+	// Span classification slack (pixels) so row spans never disagree with
+	// the per-pixel coverage test because of float rounding
+
+	constexpr double SPAN_MARGIN = 1.0;
+
+	// Width (pixels) of the coordinate tiles coverage is evaluated in; the
+	// origin of each tile is resolved in double, pixels inside it in float
+
+	constexpr int COORD_TILE = 16;
+
+	// Fixed-point coverage for integer outputs (power of two, so the
+	// float -> fixed conversion is exact up to the final rounding)
+
+	constexpr int COVERAGE_BITS = 16;
+
+	constexpr std::uint32_t COVERAGE_ONE = 1u << COVERAGE_BITS;
+
+	// Documented cross-tier tolerance of the 32-bit float output
+
+	constexpr float FLOAT_OUTPUT_TOLERANCE = 1.0f / (1 << 20);
+
+	// Downsample factor at and above which previews use draft coverage
+
+	constexpr float DRAFT_DOWNSAMPLE = 2.0f;
+
+	// Half-width (full-res pixels) of the near-step ramp of COVERAGE_HARD
+
+	constexpr float HARD_EDGE_WIDTH = 1.0f / 16.0f;
+
+}
+
+namespace SepColor {
+
+// Values of the Mode popup (1-based, as AE reports them)
+
+enum RenderMode
+{
+	MODE_LINE = 1,
+	MODE_CIRCLE = 2
+};
+
+// PixelTraits: per-format channel type, blend and color conversion.
+// Specializations live next to the pixel types they describe.
+
+template<typename PixelType>
+
+struct PixelTraits;
+
+// ============================================================================
+
+// ImageView: strided window into a pixel buffer
+
+// ============================================================================
+
+/**
+ * A view never owns memory. `data` points at the top-left pixel of the view
+ * and `rowbytes` is the signed byte distance from one row to the next, so
+ * padded rows (PF_EffectWorld::rowbytes > width * sizeof(pixel)), bottom-up
+ * buffers (negative rowbytes) and crops of a larger frame are all the same
+ * thing to the kernels.
+ *
+ * origin_x/origin_y are the layer coordinates of data[0]; SubView() keeps
+ * them in sync so geometry is always evaluated in layer space.
+ */
+
+template<typename PixelType>
+
+struct ImageView
+{
+	using ByteType = typename std::conditional<std::is_const<PixelType>::value, const char, char>::type;
+
+	PixelType *data = nullptr;
+
+	int width = 0;
+
+	int height = 0;
+
+	std::ptrdiff_t rowbytes = 0;
+
+	int origin_x = 0;
+
+	int origin_y = 0;
+
+	ImageView() = default;
+
+	ImageView(PixelType *data_, int width_, int height_, std::ptrdiff_t rowbytes_, int origin_x_ = 0, int origin_y_ = 0)
+
+		: data(data_), width(width_), height(height_), rowbytes(rowbytes_), origin_x(origin_x_), origin_y(origin_y_)
+
+	{
+
+	}
+
+	// Read-only view of the same pixels
+
+	operator ImageView<const PixelType>() const
+
+	{
+
+		return ImageView<const PixelType>(data, width, height, rowbytes, origin_x, origin_y);
+
+	}
+
+	inline PixelType *Row(int y) const
+
+	{
+
+		return reinterpret_cast<PixelType *>(reinterpret_cast<ByteType *>(data) + static_cast<std::ptrdiff_t>(y) * rowbytes);
+
+	}
+
+	inline bool Empty() const
+
+	{
+
+		return data == nullptr || width <= 0 || height <= 0;
+
+	}
+
+	// Sub-rectangle in view-local coordinates [left, right) x [top, bottom),
+	// clamped to the view. The result aliases this view's memory.
+
+	ImageView SubView(int left, int top, int right, int bottom) const
+
+	{
+
+		left = std::max(0, std::min(left, width));
+
+		right = std::max(left, std::min(right, width));
+
+		top = std::max(0, std::min(top, height));
+
+		bottom = std::max(top, std::min(bottom, height));
+
+		return ImageView(Row(top) + left, right - left, bottom - top, rowbytes, origin_x + left, origin_y + top);
+
+	}
+};
+
+// ============================================================================
+
+// Geometry: per-frame boundary description shared by every kernel
+
+// ============================================================================
+
+// Values of the Antialiasing popup, 0-based
+
+enum CoverageMode
+{
+	COVERAGE_HARD = -1,		// preview only (not in the popup): ramp over +-HARD_EDGE_WIDTH
+	COVERAGE_LINEAR = 0,	// linear ramp over +-EDGE_WIDTH (original look)
+	COVERAGE_AREA,			// exact pixel-area (box filter) coverage
+	// Filter profiles of a given width, evaluated through CoverageLut
+	COVERAGE_BOX,
+	COVERAGE_TENT,
+	COVERAGE_GAUSSIAN,
+	COVERAGE_SMOOTHSTEP
+};
+
+/**
+ * Coverage mode to render with. Draft renders (downsampled previews at
+ * DRAFT_DOWNSAMPLE or coarser, or forced) use the hard edge: its
+ * +-HARD_EDGE_WIDTH band is a fraction of an output pixel, so the row spans
+ * are almost all copy or fill, and the LUT build, area math and the
+ * transparent-pixel count of the render stats are skipped. Full resolution
+ * keeps `coverage`. COVERAGE_HARD is outside the popup range, so
+ * RenderFingerprint() keeps draft frames apart from final ones.
+ */
+
+inline int DraftCoverage(int coverage, float downsample_x, float downsample_y, bool force_draft)
+
+{
+
+	const bool draft = force_draft || std::max(downsample_x, downsample_y) >= Constants::DRAFT_DOWNSAMPLE;
+
+	return draft ? COVERAGE_HARD : coverage;
+
+}
+
+// Version of the rendered pixels. Bump whenever a change alters output
+// (kernels, coverage profiles, geometry conventions), so host frame caches
+// keyed on RenderFingerprint() drop exactly the frames that changed.
+constexpr std::uint32_t KERNEL_VERSION = 1;
+
+/**
+ * Deterministic digest of the render state a host does not see as a
+ * parameter: KERNEL_VERSION, the coverage mode actually rendered (after
+ * DraftCoverage) and the draft threshold. FNV-1a over fixed-width fields,
+ * so it is the same across sessions and machines. The SIMD ISA is left out
+ * on purpose: every ISA gives the same bits.
+ */
+
+inline std::uint64_t RenderFingerprint(int coverage)
+
+{
+
+	std::uint32_t draft_bits;
+
+	std::memcpy(&draft_bits, &Constants::DRAFT_DOWNSAMPLE, sizeof(draft_bits));
+
+	const std::uint32_t fields[3] = { KERNEL_VERSION, static_cast<std::uint32_t>(coverage), draft_bits };
+
+	std::uint64_t hash = 14695981039346656037ull;
+
+	for (std::uint32_t field : fields)
+
+	{
+
+		for (int byte = 0; byte < 4; ++byte)
+
+		{
+
+			hash = (hash ^ ((field >> (8 * byte)) & 0xFFu)) * 1099511628211ull;
+
+		}
+
+	}
+
+	return hash;
+
+}
+
+// ============================================================================
+
+// Per-frame coverage LUT for filter profiles
+
+// ============================================================================
+
+/**
+ * Maps a signed distance to the boundary (full-res pixels, positive inside)
+ * to coverage, i.e. the integral of the filter profile up to that distance.
+ * Built once per frame from + - * / only, so every platform builds the same
+ * table; each band pixel then costs one interpolated lookup.
+ */
+
+struct CoverageLut
+{
+	static constexpr int SIZE = 256;
+
+	float table[SIZE + 1] = {};
+	float d_min = 0.0f;		// distance of table[0]
+	float inv_step = 1.0f;	// entries per pixel
+	float half_width = 0.0f;	// coverage is exactly 0 / 1 beyond +-half_width
+
+	inline float Lookup(float d) const
+
+	{
+
+		float t = (d - d_min) * inv_step;
+
+		t = std::max(0.0f, std::min(static_cast<float>(SIZE), t));
+
+		const int i = std::min(static_cast<int>(t), SIZE - 1);
+
+		const float f = t - static_cast<float>(i);
+
+		return table[i] + (table[i + 1] - table[i]) * f;
+
+	}
+};
+
+namespace detail {
+
+// erf without libm (Abramowitz & Stegun 7.1.26 refined by 7.1.28, |err| < 3e-7)
+inline double ErfPoly(double x)
+
+{
+
+	const double ax = x < 0.0 ? -x : x;
+
+	const double p = 1.0 + ax * (0.0705230784 + ax * (0.0422820123 + ax * (0.0092705272 +
+
+		ax * (0.0001520143 + ax * (0.0002765672 + ax * 0.0000430638)))));
+
+	double p2 = p * p;		// p^2
+
+	p2 = p2 * p2;			// p^4
+
+	p2 = p2 * p2;			// p^8
+
+	p2 = p2 * p2;			// p^16
+
+	const double r = 1.0 - 1.0 / p2;
+
+	return x < 0.0 ? -r : r;
+
+}
+
+// Cumulative profile at normalized position u in [-1, 1] (support edges)
+inline double ProfileCdf(int profile, double u)
+
+{
+
+	if (u <= -1.0)
+
+	{
+
+		return 0.0;
+
+	}
+
+	if (u >= 1.0)
+
+	{
+
+		return 1.0;
+
+	}
+
+	switch (profile)
+
+	{
+
+	case COVERAGE_TENT:
+
+		return u < 0.0 ? 0.5 * (1.0 + u) * (1.0 + u) : 1.0 - 0.5 * (1.0 - u) * (1.0 - u);
+
+	case COVERAGE_GAUSSIAN:
+
+	{
+
+		// sigma = half support / 3, renormalized so the truncated tails meet 0 and 1
+		const double edge = ErfPoly(3.0 / 1.4142135623730951);
+
+		return 0.5 + 0.5 * ErfPoly(u * 3.0 / 1.4142135623730951) / edge;
+
+	}
+
+	case COVERAGE_SMOOTHSTEP:
+
+	{
+
+		const double t = 0.5 * (u + 1.0);
+
+		return t * t * (3.0 - 2.0 * t);
+
+	}
+
+	case COVERAGE_BOX:
+
+	default:
+
+		return 0.5 * (u + 1.0);
+
+	}
+
+}
+
+} // namespace detail
+
+/**
+ * width is the full support of the profile in full-res pixels; for the
+ * Gaussian the support is +-3 sigma.
+ */
+
+inline void BuildCoverageLut(CoverageLut &lut, int profile, float width)
+
+{
+
+	const double half = std::max(0.5 * static_cast<double>(width), 1e-3);
+
+	lut.half_width = static_cast<float>(half);
+
+	lut.d_min = static_cast<float>(-half);
+
+	lut.inv_step = static_cast<float>(CoverageLut::SIZE / (2.0 * half));
+
+	for (int i = 0; i <= CoverageLut::SIZE; ++i)
+
+	{
+
+		const double u = -1.0 + 2.0 * i / CoverageLut::SIZE;
+
+		lut.table[i] = static_cast<float>(detail::ProfileCdf(profile, u));
+
+	}
+
+}
+
+namespace detail {
+
+// sin/cos from + - * / only, so per-frame setup is identical on every libm
+inline void SinCos(double x, double &s, double &c)
+
+{
+
+	const double half_pi = 1.5707963267948966;
+
+	const double q = std::floor(x / half_pi + 0.5);
+
+	const double r = x - q * half_pi;
+
+	const double r2 = r * r;
+
+	// Taylor series, |r| <= pi/4: truncation error < 1e-16
+	double sr = 1.0 / 6227020800.0;
+
+	sr = sr * -r2 + 1.0 / 39916800.0;
+
+	sr = sr * -r2 + 1.0 / 362880.0;
+
+	sr = sr * -r2 + 1.0 / 5040.0;
+
+	sr = sr * -r2 + 1.0 / 120.0;
+
+	sr = sr * -r2 + 1.0 / 6.0;
+
+	sr = r - r * r2 * sr;
+
+	double cr = 1.0 / 87178291200.0;
+
+	cr = cr * -r2 + 1.0 / 479001600.0;
+
+	cr = cr * -r2 + 1.0 / 3628800.0;
+
+	cr = cr * -r2 + 1.0 / 40320.0;
+
+	cr = cr * -r2 + 1.0 / 720.0;
+
+	cr = cr * -r2 + 1.0 / 24.0;
+
+	cr = cr * -r2 + 0.5;
+
+	cr = 1.0 - r2 * cr;
+
+	const long long quadrant = static_cast<long long>(q) & 3;
+
+	switch (quadrant)
+
+	{
+
+	case 0: s = sr; c = cr; break;
+
+	case 1: s = cr; c = -sr; break;
+
+	case 2: s = -sr; c = -cr; break;
+
+	default: s = -cr; c = sr; break;
+
+	}
+
+}
+
+} // namespace detail
+
+struct Geometry
+{
+	int mode = MODE_LINE;
+	int coverage = COVERAGE_LINEAR;
+	double anchor_x = 0.0;		// double: layers reach 30000 px
+	double anchor_y = 0.0;
+	float downsample_x = 1.0f;
+	float downsample_y = 1.0f;
+	float radius = 0.0f;
+	float edge_width = Constants::EDGE_WIDTH;		// band half-width, full-res pixels
+	float inv_edge_width = 1.0f / Constants::EDGE_WIDTH;
+	float cs = 1.0f, sn = 0.0f;
+	float r_minus2 = -1.0f, r_plus2 = 0.0f;
+	// COVERAGE_AREA, Line mode: |normal| in output pixels, sorted (a >= b),
+	// and full-res -> output-pixel distance scale
+	float area_a = 1.0f, area_b = 0.0f, area_inv_len = 1.0f;
+	// COVERAGE_BOX .. COVERAGE_SMOOTHSTEP
+	CoverageLut lut;
+};
+
+/**
+ * anchor_* are in (downsampled) layer pixels, subpixel fraction included,
+ * radius in full-resolution pixels, downsample_* is the full-res/actual
+ * pixel ratio (den/num).
+ *
+ * A downsampled pixel stands for a downsample_x x downsample_y block of
+ * full-res pixels, so it is evaluated at the block's center, (ds - 1) / 2
+ * full-res pixels past its first pixel. Previews then line up with a
+ * box-decimated full render; at full resolution the offset is zero.
+ */
+
+inline Geometry MakeGeometry(int mode, double anchor_x, double anchor_y, float angle_rad, float radius, float downsample_x, float downsample_y, int coverage = COVERAGE_LINEAR, float profile_width = 1.0f)
+
+{
+
+	SEPCOLOR_ZONE("Geometry");
+
+	Geometry g;
+
+	g.mode = mode;
+
+	g.coverage = coverage;
+
+	g.anchor_x = anchor_x - (downsample_x - 1.0) / (2.0 * downsample_x);
+
+	g.anchor_y = anchor_y - (downsample_y - 1.0) / (2.0 * downsample_y);
+
+	g.downsample_x = downsample_x;
+
+	g.downsample_y = downsample_y;
+
+	g.radius = radius;
+
+	g.edge_width = Constants::EDGE_WIDTH;
+
+	g.inv_edge_width = 1.0f / g.edge_width;
+
+	double sn, cs;
+
+	detail::SinCos(static_cast<double>(angle_rad), sn, cs);
+
+	g.cs = static_cast<float>(cs);
+
+	g.sn = static_cast<float>(sn);
+
+	if (coverage == COVERAGE_AREA)
+
+	{
+
+		// The line's gradient in output pixels is (dsx * cs, dsy * sn); the
+		// unit square it cuts is partially covered within +-(a + b) / 2 of it.
+		const float gx = std::fabs(downsample_x * g.cs);
+
+		const float gy = std::fabs(downsample_y * g.sn);
+
+		const float len = std::max(sqrtf(gx * gx + gy * gy), 1e-12f);
+
+		g.area_a = std::max(gx, gy) / len;
+
+		g.area_b = std::min(gx, gy) / len;
+
+		g.area_inv_len = 1.0f / len;
+
+		g.edge_width = mode == MODE_LINE ?
+
+			(gx + gy) * 0.5f :
+
+			std::max(downsample_x, downsample_y) * Constants::INV_SQRT_2;
+
+	}
+
+	else if (coverage >= COVERAGE_BOX)
+
+	{
+
+		BuildCoverageLut(g.lut, coverage, profile_width);
+
+		g.edge_width = g.lut.half_width;
+
+	}
+
+	else if (coverage == COVERAGE_HARD)
+
+	{
+
+		// The Linear ramp squeezed until nearly every band pixel is 0 or 1
+		g.edge_width = Constants::HARD_EDGE_WIDTH;
+
+		g.inv_edge_width = 1.0f / g.edge_width;
+
+	}
+
+	// A ring thinner than the AA band has no solid interior
+	const float r_minus = radius - g.edge_width;
+
+	const float r_plus = radius + g.edge_width;
+
+	g.r_minus2 = r_minus > 0.0f ? r_minus * r_minus : -1.0f;
+
+	g.r_plus2 = r_plus * r_plus;
+
+	return g;
+
+}
+
+/**
+ * Exact area of the unit pixel square on the positive side of a line at
+ * signed distance d (pixels) from its center. a >= b >= 0 are the absolute
+ * components of the line's unit normal. Closed form: two quadratic corner
+ * pieces joined by a linear middle section.
+ */
+
+inline float SquareCoverage(float d, float a, float b)
+
+{
+
+	const float h = (a + b) * 0.5f;
+
+	if (d <= -h)
+
+	{
+
+		return 0.0f;
+
+	}
+
+	if (d >= h)
+
+	{
+
+		return 1.0f;
+
+	}
+
+	const float k = (a - b) * 0.5f;
+
+	if (d <= -k)
+
+	{
+
+		const float t = d + h;
+
+		return t * t / (2.0f * a * b);
+
+	}
+
+	if (d >= k)
+
+	{
+
+		const float t = h - d;
+
+		return 1.0f - t * t / (2.0f * a * b);
+
+	}
+
+	return 0.5f + d / a;
+
+}
+
+// ============================================================================
+
+// Tile-relative coordinates
+
+// ============================================================================
+
+/**
+ * On a 30000 px layer fx * fx + fy * fy reaches ~1.8e9, where a float step
+ * is 128, and the ring of a large circle turns jagged. Rather than run the
+ * kernels in double, coverage is evaluated relative to COORD_TILE-wide
+ * tiles: the tile origin is resolved once per row in double, then each
+ * pixel adds a small, exact integer offset in float. Every quantity kept in
+ * float is either bounded by the tile width or already close to the edge,
+ * so the kernels keep float precision where it matters.
+ *
+ * Tiles are aligned to layer coordinates (origin = x & ~(COORD_TILE - 1)),
+ * never to the view or span, so every kernel evaluates a given pixel with
+ * exactly the same operations.
+ */
+
+struct TileFrame
+{
+	float base;		// Line: rot_x at the tile origin. Circle: r^2 - d^2 there
+	float step;		// Line: rot_x per pixel. Circle: full-res px per pixel
+	float dx2;		// Circle: twice the tile origin's x offset (full-res px)
+	float dy;		// Circle: row offset (full-res px)
+};
+
+inline int TileOrigin(int x)
+
+{
+
+	return x & ~(Constants::COORD_TILE - 1); // floor, also for negative x
+
+}
+
+inline TileFrame MakeTileFrame(const Geometry &g, int tile_x, int y)
+
+{
+
+	const double dx = (static_cast<double>(tile_x) - g.anchor_x) * g.downsample_x;
+
+	const double dy = (static_cast<double>(y) - g.anchor_y) * g.downsample_y;
+
+	TileFrame f;
+
+	if (g.mode == MODE_LINE)
+
+	{
+
+		f.base = static_cast<float>(dx * g.cs + dy * g.sn);
+
+		f.step = g.downsample_x * g.cs;
+
+		f.dx2 = 0.0f;
+
+		f.dy = 0.0f;
+
+		return f;
+
+	}
+
+	const double r = g.radius;
+
+	f.base = static_cast<float>(r * r - (dx * dx + dy * dy));
+
+	f.step = g.downsample_x;
+
+	f.dx2 = static_cast<float>(2.0 * dx);
+
+	f.dy = static_cast<float>(dy);
+
+	return f;
+
+}
+
+/**
+ * Coverage of pixel tile_x + i (0 <= i < COORD_TILE) of the frame's row.
+ * Float only, so it vectorizes across i.
+ */
+
+inline float TileCoverage(const Geometry &g, const TileFrame &f, int i)
+
+{
+
+	const float fi = static_cast<float>(i);
+
+	if (g.mode == MODE_LINE)
+
+	{
+
+		const float rot_x = f.base + f.step * fi;
+
+		if (rot_x <= -g.edge_width)
+
+		{
+
+			return 0.0f;
+
+		}
+
+		if (rot_x >= g.edge_width)
+
+		{
+
+			return 1.0f;
+
+		}
+
+		if (g.coverage == COVERAGE_AREA)
+
+		{
+
+			return SquareCoverage(rot_x * g.area_inv_len, g.area_a, g.area_b);
+
+		}
+
+		if (g.coverage >= COVERAGE_BOX)
+
+		{
+
+			return g.lut.Lookup(rot_x);
+
+		}
+
+		return (rot_x * g.inv_edge_width + 1.0f) * 0.5f;
+
+	}
+
+	// r^2 - d^2 = base - (2 dx0 + o) o for an offset o from the tile origin,
+	// and r - d = (r^2 - d^2) / (r + d): both stay small near the ring, so
+	// the signed distance keeps its precision even when d^2 does not.
+	const float ox = f.step * fi;
+
+	const float e = f.base - (f.dx2 + ox) * ox;
+
+	const float dist = sqrtf(std::max(0.0f, g.radius * g.radius - e));
+
+	const float sd = e / std::max(g.radius + dist, 1e-12f);
+
+	if (sd <= -g.edge_width)
+
+	{
+
+		return 0.0f;
+
+	}
+
+	if (sd >= g.edge_width)
+
+	{
+
+		return 1.0f;
+
+	}
+
+	if (g.coverage >= COVERAGE_BOX)
+
+	{
+
+		return g.lut.Lookup(sd);
+
+	}
+
+	if (g.coverage == COVERAGE_AREA)
+
+	{
+
+		// Treat the circle as its tangent line at this pixel; the error is
+		// O(1 / radius) of a pixel and vanishes for radii beyond a few pixels.
+		if (dist < 1e-6f)
+
+		{
+
+			return SquareCoverage(g.radius / std::max(g.downsample_x, g.downsample_y), 1.0f, 0.0f);
+
+		}
+
+		const float gx = std::fabs(f.dx2 * 0.5f + ox) * g.downsample_x;
+
+		const float gy = std::fabs(f.dy) * g.downsample_y;
+
+		const float len = std::max(sqrtf(gx * gx + gy * gy), 1e-12f);
+
+		return SquareCoverage(sd * dist / len, std::max(gx, gy) / len, std::min(gx, gy) / len);
+
+	}
+
+	return std::max(0.0f, std::min(1.0f, (sd * g.inv_edge_width + 1.0f) * 0.5f));
+
+}
+
+// Coverage of the effect color at layer pixel (x, y), in [0, 1].
+// This is the reference every span and row kernel must agree with.
+
+inline float Coverage(const Geometry &g, int x, int y)
+
+{
+
+	const int tile_x = TileOrigin(x);
+
+	return TileCoverage(g, MakeTileFrame(g, tile_x, y), x - tile_x);
+
+}
+
+// Coverage in [0, 1] -> integer weight in [0, COVERAGE_ONE]
+
+inline std::uint32_t QuantizeCoverage(float coverage)
+
+{
+
+	return static_cast<std::uint32_t>(coverage * static_cast<float>(Constants::COVERAGE_ONE) + 0.5f);
+
+}
+
+/**
+ * Integer lerp used by every 8/16-bit output path:
+ * (src * (ONE - w) + dst * w + ONE / 2) >> COVERAGE_BITS.
+ * Fits in 32 bits for channels up to 32768 (AE 16-bit white).
+ */
+
+template<typename ChannelType>
+
+inline ChannelType BlendFixed(ChannelType src, ChannelType dst, std::uint32_t weight)
+
+{
+
+	const std::uint32_t acc = static_cast<std::uint32_t>(src) * (Constants::COVERAGE_ONE - weight) +
+
+		static_cast<std::uint32_t>(dst) * weight + (Constants::COVERAGE_ONE >> 1);
+
+	return static_cast<ChannelType>(acc >> Constants::COVERAGE_BITS);
+
+}
+
+// Apply one coverage value to one pixel. `in` and `out` may alias.
+
+template<typename PixelType>
+
+inline void ShadePixel(const PixelType &in, PixelType &out, const PixelType &color, float coverage)
+
+{
+
+	using Traits = PixelTraits<PixelType>;
+
+	if (coverage <= Constants::COVERAGE_EPSILON)
+
+	{
+
+		out = in;
+
+		return;
+
+	}
+
+	if (coverage >= Constants::COVERAGE_FULL)
+
+	{
+
+		out.red = color.red;
+
+		out.green = color.green;
+
+		out.blue = color.blue;
+
+		out.alpha = in.alpha;
+
+		return;
+
+	}
+
+	out.red = Traits::Blend(in.red, color.red, coverage);
+
+	out.green = Traits::Blend(in.green, color.green, coverage);
+
+	out.blue = Traits::Blend(in.blue, color.blue, coverage);
+
+	out.alpha = in.alpha;
+
+}
+
+// ============================================================================
+
+// Band pipeline: a coverage pass into a scratch row, then a blend pass
+
+// ============================================================================
+
+/**
+ * Scratch rows for the two-phase band pipeline (coverage pass, then blend
+ * pass), CAPACITY pixels at a time. Owned by the calling thread and reused
+ * for every row it renders, so the hot loop never allocates.
+ */
+
+struct RowScratch
+{
+	static constexpr int CAPACITY = 16 * Constants::COORD_TILE;
+
+	alignas(64) float coverage[CAPACITY];
+	alignas(64) std::uint32_t weight[CAPACITY];
+};
+
+// Per-ISA instances of sep_color_SimdKernels.h
+
+namespace simd {
+
+namespace scalar {
+using V = simd::Scalar;
+#include "sep_color_SimdKernels.h"
+} // namespace scalar
+
+#if defined(SEPCOLOR_SIMD_X86)
+SEPCOLOR_TARGET_BEGIN("sse4.1")
+namespace sse41 {
+using V = simd::Sse41;
+#include "sep_color_SimdKernels.h"
+} // namespace sse41
+SEPCOLOR_TARGET_END
+
+SEPCOLOR_TARGET_BEGIN("avx2")
+namespace avx2 {
+using V = simd::Avx2;
+#include "sep_color_SimdKernels.h"
+} // namespace avx2
+SEPCOLOR_TARGET_END
+
+// GCC 12 flags the _mm512_undefined_ps() pass-through operand of its own
+// AVX-512 intrinsics as maybe-uninitialized once they are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+SEPCOLOR_TARGET_BEGIN("avx512f")
+namespace avx512 {
+using V = simd::Avx512;
+#include "sep_color_SimdKernels.h"
+} // namespace avx512
+SEPCOLOR_TARGET_END
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#if defined(SEPCOLOR_SIMD_NEON)
+namespace neon {
+using V = simd::Neon;
+#include "sep_color_SimdKernels.h"
+} // namespace neon
+#endif
+
+} // namespace simd
+
+/**
+ * Coverage of layer pixels [x_begin, x_end) on row y, one tile frame per
+ * COORD_TILE pixels, on the widest ISA available. Bit-identical to calling
+ * Coverage() per pixel.
+ */
+
+inline void CoverageRun(const Geometry &g, int y, int x_begin, int x_end, float *cov)
+
+{
+
+	switch (ActiveSimdIsa())
+
+	{
+
+#if defined(SEPCOLOR_SIMD_X86)
+	case SIMD_AVX512: simd::avx512::CoverageRun(g, y, x_begin, x_end, cov); return;
+
+	case SIMD_AVX2: simd::avx2::CoverageRun(g, y, x_begin, x_end, cov); return;
+
+	case SIMD_SSE41: simd::sse41::CoverageRun(g, y, x_begin, x_end, cov); return;
+#endif
+#if defined(SEPCOLOR_SIMD_NEON)
+	case SIMD_NEON: simd::neon::CoverageRun(g, y, x_begin, x_end, cov); return;
+#endif
+	default: simd::scalar::CoverageRun(g, y, x_begin, x_end, cov); return;
+
+	}
+
+}
+
+/**
+ * Blend pass of the band pipeline: shade in[0 .. n) into out[0 .. n) with
+ * the coverage in scratch.coverage. Same result as ShadePixel() per pixel;
+ * `in` and `out` may alias.
+ */
+
+template<typename PixelType>
+
+inline void ShadeRun(const PixelType *in, PixelType *out, const PixelType &color, RowScratch &scratch, int n)
+
+{
+
+	switch (ActiveSimdIsa())
+
+	{
+
+#if defined(SEPCOLOR_SIMD_X86)
+	case SIMD_AVX512: simd::avx512::ShadeRun(in, out, color, scratch.coverage, scratch.weight, n); return;
+
+	case SIMD_AVX2: simd::avx2::ShadeRun(in, out, color, scratch.coverage, scratch.weight, n); return;
+
+	case SIMD_SSE41: simd::sse41::ShadeRun(in, out, color, scratch.coverage, scratch.weight, n); return;
+#endif
+#if defined(SEPCOLOR_SIMD_NEON)
+	case SIMD_NEON: simd::neon::ShadeRun(in, out, color, scratch.coverage, scratch.weight, n); return;
+#endif
+	default: simd::scalar::ShadeRun(in, out, color, scratch.coverage, scratch.weight, n); return;
+
+	}
+
+}
+
+// ============================================================================
+
+// Row spans: copy / fill / band classification per row
+
+// ============================================================================
+
+enum SpanKind
+{
+	SPAN_COPY = 0,	// coverage 0: output = input
+	SPAN_FILL,		// coverage 1: output = color, input alpha
+	SPAN_BAND		// anti-aliased band, evaluated per pixel
+};
+
+struct Span
+{
+	int begin;
+	int end;
+	SpanKind kind;
+};
+
+constexpr int MAX_ROW_SPANS = 5; // copy | band | fill | band | copy
+
+namespace detail {
+
+inline int PushSpan(Span *spans, int count, int begin, int end, SpanKind kind)
+
+{
+
+	if (end <= begin)
+
+	{
+
+		return count;
+
+	}
+
+	if (count > 0 && spans[count - 1].kind == kind && spans[count - 1].end == begin)
+
+	{
+
+		spans[count - 1].end = end;
+
+		return count;
+
+	}
+
+	spans[count].begin = begin;
+
+	spans[count].end = end;
+
+	spans[count].kind = kind;
+
+	return count + 1;
+
+}
+
+inline int ClampToRow(double v, int x_begin, int x_end)
+
+{
+
+	if (!(v > x_begin)) // also catches NaN
+
+	{
+
+		return x_begin;
+
+	}
+
+	if (v >= x_end)
+
+	{
+
+		return x_end;
+
+	}
+
+	return static_cast<int>(v);
+
+}
+
+} // namespace detail
+
+/**
+ * Split layer row y, columns [x_begin, x_end), into at most MAX_ROW_SPANS
+ * spans in left-to-right order. The boundaries are solved in double and
+ * widened by SPAN_MARGIN, so a pixel outside every band span is guaranteed
+ * to get the same answer from Coverage().
+ */
+
+inline int ClassifyRow(const Geometry &g, int y, int x_begin, int x_end, Span *spans)
+
+{
+
+	SEPCOLOR_ZONE_DETAIL("Classify");
+
+	int count = 0;
+
+	if (x_end <= x_begin)
+
+	{
+
+		return 0;
+
+	}
+
+	const double fy = (static_cast<double>(y) - g.anchor_y) * g.downsample_y;
+
+	const double ew = g.edge_width;
+
+	if (g.mode == MODE_LINE)
+
+	{
+
+		// rot_x(x) = slope * (x - anchor_x) + offset
+
+		const double slope = static_cast<double>(g.downsample_x) * g.cs;
+
+		const double offset = fy * g.sn;
+
+		if (std::fabs(slope) < 1e-9)
+
+		{
+
+			const SpanKind kind = offset <= -ew - 1e-3 ? SPAN_COPY : (offset >= ew + 1e-3 ? SPAN_FILL : SPAN_BAND);
+
+			return detail::PushSpan(spans, count, x_begin, x_end, kind);
+
+		}
+
+		// x positions where rot_x crosses -ew and +ew
+		const double xa = g.anchor_x + (-ew - offset) / slope;
+
+		const double xb = g.anchor_x + (ew - offset) / slope;
+
+		const double lo = std::min(xa, xb) - Constants::SPAN_MARGIN;
+
+		const double hi = std::max(xa, xb) + Constants::SPAN_MARGIN;
+
+		const int band_begin = detail::ClampToRow(std::floor(lo), x_begin, x_end);
+
+		const int band_end = detail::ClampToRow(std::ceil(hi) + 1.0, x_begin, x_end);
+
+		const SpanKind left = slope > 0.0 ? SPAN_COPY : SPAN_FILL;
+
+		const SpanKind right = slope > 0.0 ? SPAN_FILL : SPAN_COPY;
+
+		count = detail::PushSpan(spans, count, x_begin, band_begin, left);
+
+		count = detail::PushSpan(spans, count, band_begin, band_end, SPAN_BAND);
+
+		count = detail::PushSpan(spans, count, band_end, x_end, right);
+
+		return count;
+
+	}
+
+	// Circle: |x - anchor_x| * downsample_x < half-width of the outer/inner chord
+
+	const double dsx = std::max(static_cast<double>(g.downsample_x), 1e-6);
+
+	const double outer2 = static_cast<double>(g.r_plus2) - fy * fy;
+
+	if (outer2 <= 0.0)
+
+	{
+
+		// Keep rows that only graze the ring on the per-pixel path
+		const bool grazing = outer2 > -2.0 * (g.radius + ew) * Constants::SPAN_MARGIN * g.downsample_y;
+
+		return detail::PushSpan(spans, count, x_begin, x_end, grazing ? SPAN_BAND : SPAN_COPY);
+
+	}
+
+	const double half_outer = std::sqrt(outer2) / dsx + Constants::SPAN_MARGIN;
+
+	const int band_begin = detail::ClampToRow(std::floor(g.anchor_x - half_outer), x_begin, x_end);
+
+	const int band_end = detail::ClampToRow(std::ceil(g.anchor_x + half_outer) + 1.0, x_begin, x_end);
+
+	count = detail::PushSpan(spans, count, x_begin, band_begin, SPAN_COPY);
+
+	const double inner2 = static_cast<double>(g.r_minus2) - fy * fy;
+
+	const double half_inner = inner2 > 0.0 ? std::sqrt(inner2) / dsx - Constants::SPAN_MARGIN : -1.0;
+
+	if (half_inner > 0.0)
+
+	{
+
+		const int fill_begin = std::max(band_begin, detail::ClampToRow(std::ceil(g.anchor_x - half_inner), x_begin, x_end));
+
+		const int fill_end = std::min(band_end, detail::ClampToRow(std::floor(g.anchor_x + half_inner) + 1.0, x_begin, x_end));
+
+		if (fill_begin < fill_end)
+
+		{
+
+			count = detail::PushSpan(spans, count, band_begin, fill_begin, SPAN_BAND);
+
+			count = detail::PushSpan(spans, count, fill_begin, fill_end, SPAN_FILL);
+
+			count = detail::PushSpan(spans, count, fill_end, band_end, SPAN_BAND);
+
+			return detail::PushSpan(spans, count, band_end, x_end, SPAN_COPY);
+
+		}
+
+	}
+
+	count = detail::PushSpan(spans, count, band_begin, band_end, SPAN_BAND);
+
+	return detail::PushSpan(spans, count, band_end, x_end, SPAN_COPY);
+
+}
+
+// Summary of a coverage row, so callers can skip whole rows
+enum RowCoverage
+{
+	ROW_NONE = 0,	// every pixel has coverage 0
+	ROW_FULL,		// every pixel has coverage 1
+	ROW_MIXED
+};
+
+/**
+ * Write the coverage of layer pixels [x_begin, x_begin + count) on row y
+ * into cov[0 .. count). Copy/fill spans are written as exact 0/1, band
+ * pixels go through Coverage().
+ */
+
+inline RowCoverage CoverageRow(const Geometry &g, int y, int x_begin, int count, float *cov)
+
+{
+
+	Span spans[MAX_ROW_SPANS];
+
+	const int n = ClassifyRow(g, y, x_begin, x_begin + count, spans);
+
+	if (n == 1 && spans[0].kind != SPAN_BAND)
+
+	{
+
+		const float v = spans[0].kind == SPAN_FILL ? 1.0f : 0.0f;
+
+		std::fill(cov, cov + count, v);
+
+		return spans[0].kind == SPAN_FILL ? ROW_FULL : ROW_NONE;
+
+	}
+
+	for (int s = 0; s < n; ++s)
+
+	{
+
+		float *dst = cov + (spans[s].begin - x_begin);
+
+		const int len = spans[s].end - spans[s].begin;
+
+		if (spans[s].kind == SPAN_BAND)
+
+		{
+
+			CoverageRun(g, y, spans[s].begin, spans[s].end, dst);
+
+		}
+
+		else
+
+		{
+
+			std::fill(dst, dst + len, spans[s].kind == SPAN_FILL ? 1.0f : 0.0f);
+
+		}
+
+	}
+
+	return ROW_MIXED;
+
+}
+
+// ============================================================================
+
+// Span kernels
+
+// ============================================================================
+
+/**
+ * Optional per-worker counters of RenderRows(), for telemetry. Times are
+ * the span kernels' own, summed over the rows a worker rendered; pixel
+ * counts are per span kind, plus the fill / band pixels whose input was
+ * fully transparent (written like any other, but invisible; not counted
+ * for hard-edge draft frames).
+ */
+
+struct RenderStats
+{
+	enum Counter
+	{
+		COPY_NS = 0,
+		FILL_NS,
+		BAND_NS,
+		COPY_PX,
+		FILL_PX,
+		BAND_PX,
+		TRANSPARENT_PX,
+		COUNTERS
+	};
+
+	std::uint64_t value[COUNTERS] = {};
+};
+
+namespace detail {
+
+template<typename PixelType>
+
+inline std::uint64_t CountTransparent(const PixelType *in, int b, int e)
+
+{
+
+	std::uint64_t count = 0;
+
+	for (int x = b; x < e; ++x)
+
+	{
+
+		count += !(in[x].alpha > 0) ? 1u : 0u;
+
+	}
+
+	return count;
+
+}
+
+// Pixels [b, e) of one row (view-relative; x0 is the view's layer origin)
+template<typename PixelType>
+
+inline void RenderSpan(const PixelType *in, PixelType *out, const Geometry &g, const PixelType &color, int ly, int x0, int b, int e, SpanKind kind, bool in_place, RowScratch &scratch)
+
+{
+
+	SEPCOLOR_ZONE_DETAIL(kind == SPAN_COPY ? "Copy" : (kind == SPAN_FILL ? "Fill" : "Band span"));
+
+	switch (kind)
+
+	{
+
+	case SPAN_COPY:
+
+		if (!in_place)
+
+		{
+
+			std::memcpy(out + b, in + b, static_cast<size_t>(e - b) * sizeof(PixelType));
+
+		}
+
+		break;
+
+	case SPAN_FILL:
+
+		for (int x = b; x < e; ++x)
+
+		{
+
+			const auto alpha = in[x].alpha;
+
+			out[x] = color;
+
+			out[x].alpha = alpha;
+
+		}
+
+		break;
+
+	case SPAN_BAND:
+
+		for (int x = b; x < e; x += RowScratch::CAPACITY)
+
+		{
+
+			const int n_px = std::min(RowScratch::CAPACITY, e - x);
+
+			CoverageRun(g, ly, x0 + x, x0 + x + n_px, scratch.coverage);
+
+			ShadeRun(in + x, out + x, color, scratch, n_px);
+
+		}
+
+		break;
+
+	}
+
+}
+
+} // namespace detail
+
+/**
+ * Render rows [y_begin, y_end) of the view pair. src and dst must have the
+ * same size and origin; they may be the very same view (in-place crop), in
+ * which case copy spans are skipped. Partially overlapping views are not
+ * supported. Band spans run through `scratch`, the calling thread's rows.
+ * A non-null `stats` accumulates span timings and pixel counts; without it
+ * the loop is the same as ever, apart from one test per span.
+ */
+
+template<typename PixelType>
+
+void RenderRows(
+
+	const ImageView<const PixelType> &src,
+
+	const ImageView<PixelType> &dst,
+
+	const Geometry &g,
+
+	const PixelType &color,
+
+	int y_begin,
+
+	int y_end,
+
+	RowScratch &scratch,
+
+	RenderStats *stats = nullptr)
+
+{
+
+	const bool in_place = static_cast<const void *>(src.data) == static_cast<const void *>(dst.data) && src.rowbytes == dst.rowbytes;
+
+	const int x0 = dst.origin_x;
+
+	y_begin = std::max(0, y_begin);
+
+	y_end = std::min(dst.height, y_end);
+
+	Span spans[MAX_ROW_SPANS];
+
+	for (int y = y_begin; y < y_end; ++y)
+
+	{
+
+		const PixelType *in = src.Row(y);
+
+		PixelType *out = dst.Row(y);
+
+		const int ly = dst.origin_y + y;
+
+		const int n = ClassifyRow(g, ly, x0, x0 + dst.width, spans);
+
+		for (int s = 0; s < n; ++s)
+
+		{
+
+			const int b = spans[s].begin - x0;
+
+			const int e = spans[s].end - x0;
+
+			if (stats == nullptr)
+
+			{
+
+				detail::RenderSpan(in, out, g, color, ly, x0, b, e, spans[s].kind, in_place, scratch);
+
+				continue;
+
+			}
+
+			// The counters of each group are in SpanKind order
+			const int kind = spans[s].kind;
+
+			if (kind != SPAN_COPY && g.coverage != COVERAGE_HARD)
+
+			{
+
+				// Before the kernel: in place, it overwrites the input.
+				// Not counted for draft (hard-edge) frames
+				stats->value[RenderStats::TRANSPARENT_PX] += detail::CountTransparent(in, b, e);
+
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+
+			detail::RenderSpan(in, out, g, color, ly, x0, b, e, spans[s].kind, in_place, scratch);
+
+			const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+			stats->value[RenderStats::COPY_NS + kind] += static_cast<std::uint64_t>(elapsed.count());
+
+			stats->value[RenderStats::COPY_PX + kind] += static_cast<std::uint64_t>(e - b);
+
+		}
+
+	}
+
+}
+
+// Same, with scratch rows on the stack for one call
+
+template<typename PixelType>
+
+void RenderRows(
+
+	const ImageView<const PixelType> &src,
+
+	const ImageView<PixelType> &dst,
+
+	const Geometry &g,
+
+	const PixelType &color,
+
+	int y_begin,
+
+	int y_end)
+
+{
+
+	RowScratch scratch;
+
+	RenderRows(src, dst, g, color, y_begin, y_end, scratch);
+
+}
+
+// Whole-view convenience wrapper (single-threaded; callers that want
+// parallelism split the rows themselves)
+
+template<typename PixelType>
+
+void RenderView(const ImageView<const PixelType> &src, const ImageView<PixelType> &dst, const Geometry &g, const PixelType &color)
+
+{
+
+	RenderRows(src, dst, g, color, 0, dst.height);
+
+}
+
+// ============================================================================
+
+// Incremental re-render
+
+// ============================================================================
+
+/**
+ * Re-render rows [y_begin, y_end) on top of the frame dst already holds,
+ * which was rendered from the same src pixels and color with `prev`. Only
+ * pixels whose result can differ are written: the region the boundary
+ * swept (copy <-> fill) and both frames' AA bands. Outside every band,
+ * coverage is exactly 0 or 1 whatever the geometry, so a pixel that is copy
+ * (or fill) in both frames already holds the right value. The work follows
+ * how far the edge moved instead of the frame size.
+ *
+ * Everything else must match the previous frame: src content, color, view
+ * size and origin, and pixel format. src and dst must not alias: a pixel
+ * that turns from fill back to copy needs the input it replaced.
+ */
+
+template<typename PixelType>
+
+void RenderRowsDelta(
+
+	const ImageView<const PixelType> &src,
+
+	const ImageView<PixelType> &dst,
+
+	const Geometry &prev,
+
+	const Geometry &g,
+
+	const PixelType &color,
+
+	int y_begin,
+
+	int y_end,
+
+	RowScratch &scratch)
+
+{
+
+	const int x0 = dst.origin_x;
+
+	y_begin = std::max(0, y_begin);
+
+	y_end = std::min(dst.height, y_end);
+
+	Span old_spans[MAX_ROW_SPANS];
+
+	Span spans[MAX_ROW_SPANS];
+
+	for (int y = y_begin; y < y_end; ++y)
+
+	{
+
+		const int ly = dst.origin_y + y;
+
+		const int n_old = ClassifyRow(prev, ly, x0, x0 + dst.width, old_spans);
+
+		const int n = ClassifyRow(g, ly, x0, x0 + dst.width, spans);
+
+		const PixelType *in = src.Row(y);
+
+		PixelType *out = dst.Row(y);
+
+		// Walk both span lists together; each step ends at the nearer
+		// boundary, so both kinds are constant within [x, stop)
+		int i_old = 0;
+
+		int i = 0;
+
+		int x = x0;
+
+		while (i < n && i_old < n_old)
+
+		{
+
+			const int stop = std::min(spans[i].end, old_spans[i_old].end);
+
+			const SpanKind kind = spans[i].kind;
+
+			if (kind == SPAN_BAND || kind != old_spans[i_old].kind)
+
+			{
+
+				detail::RenderSpan(in, out, g, color, ly, x0, x - x0, stop - x0, kind, false, scratch);
+
+			}
+
+			x = stop;
+
+			i += spans[i].end == stop ? 1 : 0;
+
+			i_old += old_spans[i_old].end == stop ? 1 : 0;
+
+		}
+
+	}
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_CORE_H
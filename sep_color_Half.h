@@ -0,0 +1,454 @@
+#pragma once
+
+#ifndef SEP_COLOR_HALF_H
+#define SEP_COLOR_HALF_H
+
+// Half-float (IEEE 754 binary16) RGBA support for the sep_color core.
+// AE never hands us half worlds; this is for offline/OFX pipelines that keep
+// intermediates in FP16 and want to skip the round trip through 32-bit float.
+// Copy and fill spans move half bits directly; only band pixels are converted.
+
+#include "sep_color_Core.h"
+
+#include <cstdint>
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SEPCOLOR_HALF_NEON 1
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SEPCOLOR_HALF_F16C 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SEPCOLOR_TARGET_F16C
+#else
+#define SEPCOLOR_TARGET_F16C __attribute__((target("f16c")))
+#endif
+#endif
+
+namespace SepColor {
+
+// RGBA, 16 bits per channel, each channel an IEEE binary16 bit pattern
+
+struct PixelHalf
+{
+	std::uint16_t red;
+	std::uint16_t green;
+	std::uint16_t blue;
+	std::uint16_t alpha;
+};
+
+static_assert(sizeof(PixelHalf) == 8, "PixelHalf must be 4 x 16 bits");
+
+namespace half {
+
+// ------------------------------------------------------------
+// Portable scalar conversions (round-to-nearest-even)
+// ------------------------------------------------------------
+
+inline float ToFloatScalar(std::uint16_t h)
+
+{
+
+	const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+
+	std::uint32_t exp = (h >> 10) & 0x1Fu;
+
+	std::uint32_t mant = h & 0x3FFu;
+
+	std::uint32_t bits;
+
+	if (exp == 0x1Fu)
+
+	{
+
+		bits = sign | 0x7F800000u | (mant << 13) | (mant ? 0x400000u : 0u); // Inf / quiet NaN, as F16C/NEON do
+
+	}
+
+	else if (exp != 0)
+
+	{
+
+		bits = sign | ((exp + 112u) << 23) | (mant << 13);
+
+	}
+
+	else if (mant == 0)
+
+	{
+
+		bits = sign; // +-0
+
+	}
+
+	else
+
+	{
+
+		// Subnormal: renormalize
+		exp = 113u;
+
+		while ((mant & 0x400u) == 0)
+
+		{
+
+			mant <<= 1;
+
+			--exp;
+
+		}
+
+		bits = sign | (exp << 23) | ((mant & 0x3FFu) << 13);
+
+	}
+
+	float f;
+
+	std::memcpy(&f, &bits, sizeof(f));
+
+	return f;
+
+}
+
+inline std::uint16_t FromFloatScalar(float f)
+
+{
+
+	std::uint32_t bits;
+
+	std::memcpy(&bits, &f, sizeof(bits));
+
+	const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+
+	const std::uint32_t abs = bits & 0x7FFFFFFFu;
+
+	if (abs >= 0x7F800000u)
+
+	{
+
+		// Inf stays Inf, NaN stays a quiet NaN
+		return static_cast<std::uint16_t>(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0u));
+
+	}
+
+	if (abs >= 0x477FF000u)
+
+	{
+
+		return static_cast<std::uint16_t>(sign | 0x7C00u); // overflow -> Inf
+
+	}
+
+	if (abs < 0x38800000u)
+
+	{
+
+		// Result is subnormal or zero
+		if (abs < 0x33000000u)
+
+		{
+
+			return sign;
+
+		}
+
+		const std::uint32_t exp = abs >> 23;
+
+		const std::uint32_t mant = (abs & 0x7FFFFFu) | 0x800000u;
+
+		const std::uint32_t shift = 126u - exp;
+
+		std::uint32_t h = mant >> shift;
+
+		const std::uint32_t rem = mant & ((1u << shift) - 1u);
+
+		const std::uint32_t halfway = 1u << (shift - 1u);
+
+		if (rem > halfway || (rem == halfway && (h & 1u)))
+
+		{
+
+			++h;
+
+		}
+
+		return static_cast<std::uint16_t>(sign | h);
+
+	}
+
+	std::uint32_t h = ((abs - 0x38000000u) >> 13);
+
+	const std::uint32_t rem = abs & 0x1FFFu;
+
+	if (rem > 0x1000u || (rem == 0x1000u && (h & 1u)))
+
+	{
+
+		++h; // may carry into the exponent, which is still correct
+
+	}
+
+	return static_cast<std::uint16_t>(sign | h);
+
+}
+
+inline void ToFloat4Scalar(const std::uint16_t *h, float *f)
+
+{
+
+	for (int i = 0; i < 4; ++i)
+
+	{
+
+		f[i] = ToFloatScalar(h[i]);
+
+	}
+
+}
+
+inline void FromFloat4Scalar(const float *f, std::uint16_t *h)
+
+{
+
+	for (int i = 0; i < 4; ++i)
+
+	{
+
+		h[i] = FromFloatScalar(f[i]);
+
+	}
+
+}
+
+// ------------------------------------------------------------
+// Hardware conversions, 4 channels at a time
+// ------------------------------------------------------------
+
+#if defined(SEPCOLOR_HALF_F16C)
+
+SEPCOLOR_TARGET_F16C inline void ToFloat4F16C(const std::uint16_t *h, float *f)
+
+{
+
+	_mm_storeu_ps(f, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(h))));
+
+}
+
+SEPCOLOR_TARGET_F16C inline void FromFloat4F16C(const float *f, std::uint16_t *h)
+
+{
+
+	_mm_storel_epi64(reinterpret_cast<__m128i *>(h), _mm_cvtps_ph(_mm_loadu_ps(f), _MM_FROUND_TO_NEAREST_INT));
+
+}
+
+// F16C needs the CPU flag and OS-enabled AVX state; checked once
+
+inline bool HasF16C()
+
+{
+
+	static const bool has = []() {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		const bool f16c = (info[2] & (1 << 29)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		return f16c && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+	}();
+
+	return has;
+
+}
+
+#endif
+
+inline void ToFloat4(const std::uint16_t *h, float *f)
+
+{
+#if defined(SEPCOLOR_HALF_NEON)
+	vst1q_f32(f, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(h))));
+#elif defined(SEPCOLOR_HALF_F16C)
+	if (HasF16C())
+	{
+		ToFloat4F16C(h, f);
+		return;
+	}
+	ToFloat4Scalar(h, f);
+#else
+	ToFloat4Scalar(h, f);
+#endif
+}
+
+inline void FromFloat4(const float *f, std::uint16_t *h)
+
+{
+#if defined(SEPCOLOR_HALF_NEON)
+	vst1_u16(h, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(f))));
+#elif defined(SEPCOLOR_HALF_F16C)
+	if (HasF16C())
+	{
+		FromFloat4F16C(f, h);
+		return;
+	}
+	FromFloat4Scalar(f, h);
+#else
+	FromFloat4Scalar(f, h);
+#endif
+}
+
+} // namespace half
+
+// Specialization for half-float RGBA pixels (PixelHalf)
+
+template<>
+
+struct PixelTraits<PixelHalf>
+
+{
+
+	using ChannelType = std::uint16_t;
+
+	using PixelType = PixelHalf;
+
+	static constexpr bool IsFloat = true;
+
+	// Per-channel blend, same formula as the 32-bit float path. Band pixels
+	// go through the ShadePixel overload below instead, which converts all
+	// four channels in one instruction.
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		const float s = half::ToFloatScalar(src);
+
+		return half::FromFloatScalar(s + (half::ToFloatScalar(dst) - s) * coverage);
+
+	}
+
+	static inline bool IsTransparent(const PixelType& px)
+
+	{
+
+		return half::ToFloatScalar(px.alpha) <= 0.0f;
+
+	}
+
+	static inline void CopyPixel(const PixelType& src, PixelType& dst)
+
+	{
+
+		dst = src;
+
+	}
+
+	// Effect color from float RGB (alpha is always taken from the input)
+	static inline void ConvertColorFloat(float r, float g, float b, PixelType& out)
+
+	{
+
+		const float rgba[4] = {r, g, b, 1.0f};
+
+		half::FromFloat4(rgba, &out.red);
+
+	}
+
+	static inline void ConvertColor8(unsigned char r, unsigned char g, unsigned char b, PixelType& out)
+
+	{
+
+		ConvertColorFloat(r * Constants::COLOR_SCALE_8_TO_FLOAT, g * Constants::COLOR_SCALE_8_TO_FLOAT, b * Constants::COLOR_SCALE_8_TO_FLOAT, out);
+
+	}
+
+};
+
+namespace detail {
+
+// Render stats of half rows: alpha holds half bits, so the generic
+// `!(alpha > 0)` would read -0 and negative alphas as opaque. Same test as
+// !(ToFloatScalar(alpha) > 0) without the decode: zero, negative or NaN.
+
+template<>
+
+inline std::uint64_t CountTransparent<PixelHalf>(const PixelHalf *in, int b, int e)
+
+{
+
+	std::uint64_t count = 0;
+
+	for (int x = b; x < e; ++x)
+
+	{
+
+		const std::uint16_t alpha = in[x].alpha;
+
+		count += (alpha & 0x8000u) != 0 || alpha == 0 || alpha > 0x7C00u ? 1u : 0u;
+
+	}
+
+	return count;
+
+}
+
+} // namespace detail
+
+// Band pixel for half RGBA: widen once, blend in float, narrow once.
+// Found by ADL from RenderRows, so the generic kernels need no changes.
+
+inline void ShadePixel(const PixelHalf &in, PixelHalf &out, const PixelHalf &color, float coverage)
+
+{
+
+	if (coverage <= Constants::COVERAGE_EPSILON)
+
+	{
+
+		out = in;
+
+		return;
+
+	}
+
+	const std::uint16_t alpha = in.alpha;
+
+	if (coverage >= Constants::COVERAGE_FULL)
+
+	{
+
+		out = color;
+
+		out.alpha = alpha;
+
+		return;
+
+	}
+
+	float s[4], c[4];
+
+	half::ToFloat4(&in.red, s);
+
+	half::ToFloat4(&color.red, c);
+
+	for (int i = 0; i < 3; ++i)
+
+	{
+
+		s[i] = s[i] + (c[i] - s[i]) * coverage;
+
+	}
+
+	half::FromFloat4(s, &out.red);
+
+	out.alpha = alpha;
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_HALF_H
@@ -0,0 +1,1122 @@
+// OpenFX build of sep_color for Linux compositing hosts.
+// Same parameters, modes and kernels as the AE plugin: everything below is
+// host glue around the SDK-free core (sep_color_Scheduler.h). Only the OFX
+// C API headers are needed (plain C suites, no C++ support library); see
+// Linux/Makefile.
+//
+// - Contexts: Filter and General, one Source and one Output clip, RGBA.
+// - Depths: 8-bit, 16-bit (full 0..65535 range) and 32-bit float.
+// - Tiles and render scale are supported; the render window is rendered
+//   in place of the whole image.
+// - Threads: the frame is split into cost-balanced bands and rendered on
+//   the host's MultiThread suite, the AE iterate_generic equivalent.
+// - Incremental (Static Input), OFX only: while the source image is
+//   unchanged, each frame redraws only what the edge swept since the last.
+//
+// OFX pixel space is y-up, AE layer space is y-down: the angle is negated
+// so a given angle gives the same picture in both hosts.
+
+#include "ofxCore.h"
+
+#include "ofxImageEffect.h"
+
+#include "ofxMultiThread.h"
+
+#include "ofxParam.h"
+
+#include "ofxProperty.h"
+
+#include "sep_color_Scheduler.h"
+
+#include "sep_color_Autotune.h"
+
+#include "sep_color_Version.h"
+
+#include <cstdint>
+
+#include <cstring>
+
+#include <mutex>
+
+#include <string>
+
+#include <vector>
+
+namespace SepColor {
+
+// OFX pixel layouts: RGBA, channels in this order for every depth
+
+struct PixelRGBA8
+{
+	std::uint8_t red, green, blue, alpha;
+};
+
+struct PixelRGBA16
+{
+	std::uint16_t red, green, blue, alpha;
+};
+
+struct PixelRGBA32
+{
+	float red, green, blue, alpha;
+};
+
+// Specialization for 8-bit RGBA
+
+template<>
+
+struct PixelTraits<PixelRGBA8>
+
+{
+
+	using ChannelType = std::uint8_t;
+
+	using PixelType = PixelRGBA8;
+
+	static constexpr float MAX_CHANNEL = 255.0f;
+
+	static constexpr bool IsFloat = false;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return BlendFixed(src, dst, QuantizeCoverage(coverage));
+
+	}
+
+	static inline void ConvertColorFloat(float r, float g, float b, PixelType& out)
+
+	{
+
+		out.red = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, r)) * MAX_CHANNEL + 0.5f);
+
+		out.green = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, g)) * MAX_CHANNEL + 0.5f);
+
+		out.blue = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, b)) * MAX_CHANNEL + 0.5f);
+
+		out.alpha = static_cast<ChannelType>(MAX_CHANNEL);
+
+	}
+
+};
+
+// Specialization for 16-bit RGBA (OFX shorts use the full 16-bit range)
+
+template<>
+
+struct PixelTraits<PixelRGBA16>
+
+{
+
+	using ChannelType = std::uint16_t;
+
+	using PixelType = PixelRGBA16;
+
+	static constexpr float MAX_CHANNEL = 65535.0f;
+
+	static constexpr bool IsFloat = false;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return BlendFixed(src, dst, QuantizeCoverage(coverage));
+
+	}
+
+	static inline void ConvertColorFloat(float r, float g, float b, PixelType& out)
+
+	{
+
+		out.red = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, r)) * MAX_CHANNEL + 0.5f);
+
+		out.green = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, g)) * MAX_CHANNEL + 0.5f);
+
+		out.blue = static_cast<ChannelType>(std::max(0.0f, std::min(1.0f, b)) * MAX_CHANNEL + 0.5f);
+
+		out.alpha = static_cast<ChannelType>(MAX_CHANNEL);
+
+	}
+
+};
+
+// Specialization for 32-bit float RGBA
+
+template<>
+
+struct PixelTraits<PixelRGBA32>
+
+{
+
+	using ChannelType = float;
+
+	using PixelType = PixelRGBA32;
+
+	static constexpr bool IsFloat = true;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return src + (dst - src) * coverage;
+
+	}
+
+	// Float color is used as is (no clamping: scene-referred values allowed)
+	static inline void ConvertColorFloat(float r, float g, float b, PixelType& out)
+
+	{
+
+		out.red = r;
+
+		out.green = g;
+
+		out.blue = b;
+
+		out.alpha = 1.0f;
+
+	}
+
+};
+
+} // namespace SepColor
+
+// -------------------------------------------------------------
+
+// Host suites (fetched once in setHost / OfxActionLoad)
+
+// -------------------------------------------------------------
+
+static OfxHost *g_host = nullptr;
+
+static const OfxPropertySuiteV1 *g_prop = nullptr;
+
+static const OfxImageEffectSuiteV1 *g_effect = nullptr;
+
+static const OfxParameterSuiteV1 *g_param = nullptr;
+
+static const OfxMultiThreadSuiteV1 *g_thread = nullptr;
+
+// Parameter names (script names; labels match the AE plugin)
+
+static const char *const PARAM_ANCHOR = "anchor";
+
+static const char *const PARAM_MODE = "mode";
+
+static const char *const PARAM_ANGLE = "angle";
+
+static const char *const PARAM_RADIUS = "radius";
+
+static const char *const PARAM_COLOR = "color";
+
+static const char *const PARAM_ANTIALIAS = "antialias";
+
+static const char *const PARAM_EDGE_WIDTH = "edgeWidth";
+
+static const char *const PARAM_DRAFT = "draft";
+
+static const char *const PARAM_INCREMENTAL = "incremental";
+
+// Clip image, released when it goes out of scope
+
+class ClipImage
+{
+public:
+	ClipImage(OfxImageEffectHandle effect, const char *clip_name, OfxTime time)
+	{
+		OfxImageClipHandle clip = nullptr;
+
+		if (g_effect->clipGetHandle(effect, clip_name, &clip, nullptr) == kOfxStatOK)
+
+		{
+
+			g_effect->clipGetImage(clip, time, nullptr, &image_);
+
+		}
+	}
+
+	~ClipImage()
+	{
+		if (image_ != nullptr)
+
+		{
+
+			g_effect->clipReleaseImage(image_);
+
+		}
+	}
+
+	ClipImage(const ClipImage &) = delete;
+	ClipImage &operator=(const ClipImage &) = delete;
+
+	OfxPropertySetHandle Props() const
+	{
+		return image_;
+	}
+
+	/**
+	 * View of the image in pixel coordinates (y-up; row 0 is bounds.y1),
+	 * cropped to `window`. rowbytes may be negative, which ImageView takes.
+	 */
+	template<typename PixelType>
+	SepColor::ImageView<PixelType> View(const OfxRectI &window) const
+	{
+		void *data = nullptr;
+
+		OfxRectI bounds;
+
+		int rowbytes = 0;
+
+		g_prop->propGetPointer(image_, kOfxImagePropData, 0, &data);
+
+		g_prop->propGetIntN(image_, kOfxImagePropBounds, 4, &bounds.x1);
+
+		g_prop->propGetInt(image_, kOfxImagePropRowBytes, 0, &rowbytes);
+
+		const SepColor::ImageView<PixelType> whole(
+
+			static_cast<PixelType *>(data),
+
+			bounds.x2 - bounds.x1,
+
+			bounds.y2 - bounds.y1,
+
+			rowbytes,
+
+			bounds.x1,
+
+			bounds.y1);
+
+		return whole.SubView(window.x1 - bounds.x1, window.y1 - bounds.y1, window.x2 - bounds.x1, window.y2 - bounds.y1);
+	}
+
+private:
+	OfxPropertySetHandle image_ = nullptr;
+};
+
+// -------------------------------------------------------------
+
+// Describe
+
+// -------------------------------------------------------------
+
+static OfxStatus Describe(OfxImageEffectHandle effect)
+
+{
+
+	OfxPropertySetHandle props = nullptr;
+
+	g_effect->getPropertySet(effect, &props);
+
+	g_prop->propSetString(props, kOfxPropLabel, 0, "sep_color");
+
+	g_prop->propSetString(props, kOfxImageEffectPluginPropGrouping, 0, "361do");
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedContexts, 0, kOfxImageEffectContextFilter);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedContexts, 1, kOfxImageEffectContextGeneral);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedPixelDepths, 0, kOfxBitDepthByte);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedPixelDepths, 1, kOfxBitDepthShort);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedPixelDepths, 2, kOfxBitDepthFloat);
+
+	g_prop->propSetInt(props, kOfxImageEffectPropSupportsTiles, 0, 1);
+
+	g_prop->propSetInt(props, kOfxImageEffectPropSupportsMultiResolution, 0, 1);
+
+	// Threads come from the MultiThread suite inside one render call
+	g_prop->propSetInt(props, kOfxImageEffectPluginPropHostFrameThreading, 0, 0);
+
+	g_prop->propSetString(props, kOfxImageEffectPluginRenderThreadSafety, 0, kOfxImageEffectRenderFullySafe);
+
+	return kOfxStatOK;
+
+}
+
+static OfxPropertySetHandle DefineParam(OfxParamSetHandle params, const char *type, const char *name, const char *label)
+
+{
+
+	OfxPropertySetHandle props = nullptr;
+
+	g_param->paramDefine(params, type, name, &props);
+
+	g_prop->propSetString(props, kOfxPropLabel, 0, label);
+
+	return props;
+
+}
+
+static OfxStatus DescribeInContext(OfxImageEffectHandle effect)
+
+{
+
+	OfxPropertySetHandle props = nullptr;
+
+	g_effect->clipDefine(effect, kOfxImageEffectSimpleSourceClipName, &props);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedComponents, 0, kOfxImageComponentRGBA);
+
+	g_prop->propSetInt(props, kOfxImageClipPropSupportsTiles, 0, 1);
+
+	g_effect->clipDefine(effect, kOfxImageEffectOutputClipName, &props);
+
+	g_prop->propSetString(props, kOfxImageEffectPropSupportedComponents, 0, kOfxImageComponentRGBA);
+
+	g_prop->propSetInt(props, kOfxImageClipPropSupportsTiles, 0, 1);
+
+	OfxParamSetHandle params = nullptr;
+
+	g_effect->getParamSet(effect, &params);
+
+	// Same order, ranges and defaults as ParamsSetup() in sep_color.cpp
+	props = DefineParam(params, kOfxParamTypeDouble2D, PARAM_ANCHOR, "Anchor Point");
+
+	g_prop->propSetString(props, kOfxParamPropDoubleType, 0, kOfxParamDoubleTypeXYAbsolute);
+
+	g_prop->propSetString(props, kOfxParamPropDefaultCoordinateSystem, 0, kOfxParamCoordinatesNormalised);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 0, 0.5);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 1, 0.5);
+
+	props = DefineParam(params, kOfxParamTypeChoice, PARAM_MODE, "Mode");
+
+	g_prop->propSetString(props, kOfxParamPropChoiceOption, 0, "Line");
+
+	g_prop->propSetString(props, kOfxParamPropChoiceOption, 1, "Circle");
+
+	g_prop->propSetInt(props, kOfxParamPropDefault, 0, 0);
+
+	props = DefineParam(params, kOfxParamTypeDouble, PARAM_ANGLE, "Angle");
+
+	g_prop->propSetString(props, kOfxParamPropDoubleType, 0, kOfxParamDoubleTypeAngle);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 0, 0.0);
+
+	props = DefineParam(params, kOfxParamTypeDouble, PARAM_RADIUS, "Radius");
+
+	g_prop->propSetDouble(props, kOfxParamPropMin, 0, 0.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropMax, 0, 3000.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDisplayMin, 0, 0.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDisplayMax, 0, 500.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 0, 100.0);
+
+	g_prop->propSetInt(props, kOfxParamPropDigits, 0, 0);
+
+	props = DefineParam(params, kOfxParamTypeRGB, PARAM_COLOR, "Color");
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 0, 1.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 1, 0.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 2, 0.0);
+
+	props = DefineParam(params, kOfxParamTypeChoice, PARAM_ANTIALIAS, "Antialiasing");
+
+	const char *const profiles[] = {"Linear", "Exact Area", "Box", "Tent", "Gaussian", "Smoothstep"};
+
+	for (int i = 0; i < 6; ++i)
+
+	{
+
+		g_prop->propSetString(props, kOfxParamPropChoiceOption, i, profiles[i]);
+
+	}
+
+	g_prop->propSetInt(props, kOfxParamPropDefault, 0, SepColor::COVERAGE_LINEAR);
+
+	props = DefineParam(params, kOfxParamTypeDouble, PARAM_EDGE_WIDTH, "Edge Width");
+
+	g_prop->propSetDouble(props, kOfxParamPropMin, 0, 0.1);
+
+	g_prop->propSetDouble(props, kOfxParamPropMax, 0, 200.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDisplayMin, 0, 0.5);
+
+	g_prop->propSetDouble(props, kOfxParamPropDisplayMax, 0, 20.0);
+
+	g_prop->propSetDouble(props, kOfxParamPropDefault, 0, 1.0);
+
+	g_prop->propSetInt(props, kOfxParamPropDigits, 0, 1);
+
+	props = DefineParam(params, kOfxParamTypeBoolean, PARAM_DRAFT, "Draft Quality");
+
+	g_prop->propSetInt(props, kOfxParamPropDefault, 0, 0);
+
+	props = DefineParam(params, kOfxParamTypeBoolean, PARAM_INCREMENTAL, "Incremental (Static Input)");
+
+	g_prop->propSetString(props, kOfxParamPropHint, 0, "Keep the last output and redraw only what the edge swept while the source image is unchanged");
+
+	g_prop->propSetInt(props, kOfxParamPropDefault, 0, 0);
+
+	return kOfxStatOK;
+
+}
+
+// -------------------------------------------------------------
+
+// Incremental rendering (Incremental (Static Input) parameter)
+
+// -------------------------------------------------------------
+
+/**
+ * Last output of one effect instance, kept in kOfxPropInstanceData. While
+ * the source image keeps its host-assigned kOfxImagePropUniqueIdentifier
+ * (the host changes it whenever the pixels change) and the window, depth
+ * and color match, the next frame starts from these pixels and redraws
+ * only what the edge swept (RenderRowsDelta), then is copied out. One
+ * frame per instance: a render that finds the cache busy on another thread
+ * renders in full without it.
+ */
+
+struct FrameCache
+{
+	std::mutex lock;
+	bool valid = false;
+	std::string source_id;
+	OfxRectI window = {};
+	std::size_t pixel_size = 0;
+	unsigned char color[sizeof(SepColor::PixelRGBA32)] = {};
+	SepColor::Geometry geom;
+	std::vector<unsigned char> pixels;
+
+	template<typename PixelType>
+	bool Matches(const std::string &id, const OfxRectI &w, const PixelType &c) const
+	{
+		return valid && id == source_id && pixel_size == sizeof(PixelType) &&
+			w.x1 == window.x1 && w.y1 == window.y1 && w.x2 == window.x2 && w.y2 == window.y2 &&
+			std::memcmp(color, &c, sizeof(PixelType)) == 0;
+	}
+
+	// Take the cache for a full render of a new key
+	template<typename PixelType>
+	void Reset(const std::string &id, const OfxRectI &w, const PixelType &c)
+	{
+		valid = false;
+		source_id = id;
+		window = w;
+		pixel_size = sizeof(PixelType);
+		std::memcpy(color, &c, sizeof(PixelType));
+		pixels.resize(static_cast<std::size_t>(w.x2 - w.x1) * (w.y2 - w.y1) * sizeof(PixelType));
+	}
+
+	template<typename PixelType>
+	SepColor::ImageView<PixelType> View()
+	{
+		const int width = window.x2 - window.x1;
+
+		return SepColor::ImageView<PixelType>(reinterpret_cast<PixelType *>(pixels.data()), width, window.y2 - window.y1, width * static_cast<int>(sizeof(PixelType)), window.x1, window.y1);
+	}
+};
+
+static FrameCache *InstanceCache(OfxImageEffectHandle effect)
+
+{
+
+	OfxPropertySetHandle props = nullptr;
+
+	void *cache = nullptr;
+
+	if (g_effect->getPropertySet(effect, &props) != kOfxStatOK || g_prop->propGetPointer(props, kOfxPropInstanceData, 0, &cache) != kOfxStatOK)
+
+	{
+
+		return nullptr;
+
+	}
+
+	return static_cast<FrameCache *>(cache);
+
+}
+
+// Host label of the source pixels, empty when the host does not set one
+static std::string SourceId(const ClipImage &src)
+
+{
+
+	char *id = nullptr;
+
+	if (g_prop->propGetString(src.Props(), kOfxImagePropUniqueIdentifier, 0, &id) != kOfxStatOK || id == nullptr)
+
+	{
+
+		return std::string();
+
+	}
+
+	return std::string(id);
+
+}
+
+static OfxStatus CreateInstance(OfxImageEffectHandle effect)
+
+{
+
+	OfxPropertySetHandle props = nullptr;
+
+	g_effect->getPropertySet(effect, &props);
+
+	return g_prop->propSetPointer(props, kOfxPropInstanceData, 0, new FrameCache());
+
+}
+
+static OfxStatus DestroyInstance(OfxImageEffectHandle effect)
+
+{
+
+	delete InstanceCache(effect);
+
+	OfxPropertySetHandle props = nullptr;
+
+	g_effect->getPropertySet(effect, &props);
+
+	g_prop->propSetPointer(props, kOfxPropInstanceData, 0, nullptr);
+
+	return kOfxStatOK;
+
+}
+
+// -------------------------------------------------------------
+
+// Render
+
+// -------------------------------------------------------------
+
+struct RenderParams
+{
+	double anchor_x = 0.0, anchor_y = 0.0;
+	int mode = 0;
+	double angle = 0.0;
+	double radius = 0.0;
+	double color[3] = {};
+	int antialias = 0;
+	double edge_width = 1.0;
+	int draft = 0;
+	int incremental = 0;
+};
+
+static RenderParams FetchParams(OfxImageEffectHandle effect, OfxTime time)
+
+{
+
+	OfxParamSetHandle params = nullptr;
+
+	g_effect->getParamSet(effect, &params);
+
+	RenderParams p;
+
+	OfxParamHandle h = nullptr;
+
+	g_param->paramGetHandle(params, PARAM_ANCHOR, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.anchor_x, &p.anchor_y);
+
+	g_param->paramGetHandle(params, PARAM_MODE, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.mode);
+
+	g_param->paramGetHandle(params, PARAM_ANGLE, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.angle);
+
+	g_param->paramGetHandle(params, PARAM_RADIUS, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.radius);
+
+	g_param->paramGetHandle(params, PARAM_COLOR, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.color[0], &p.color[1], &p.color[2]);
+
+	g_param->paramGetHandle(params, PARAM_ANTIALIAS, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.antialias);
+
+	g_param->paramGetHandle(params, PARAM_EDGE_WIDTH, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.edge_width);
+
+	g_param->paramGetHandle(params, PARAM_DRAFT, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.draft);
+
+	g_param->paramGetHandle(params, PARAM_INCREMENTAL, &h, nullptr);
+
+	g_param->paramGetValueAtTime(h, time, &p.incremental);
+
+	return p;
+
+}
+
+/**
+ * Canonical coordinates -> the core's pixel space. Canonical x is in
+ * square pixels (divide by the pixel aspect ratio), and a pixel's index
+ * sits half a pixel below its center.
+ */
+
+static SepColor::Geometry GeometryFromParams(const RenderParams &p, const OfxPointD &render_scale, double pixel_aspect)
+
+{
+
+	const float downsample_x = static_cast<float>(1.0 / render_scale.x);
+
+	const float downsample_y = static_cast<float>(1.0 / render_scale.y);
+
+	return SepColor::MakeGeometry(
+
+		p.mode + 1,
+
+		(p.anchor_x / pixel_aspect - 0.5) * render_scale.x,
+
+		(p.anchor_y - 0.5) * render_scale.y,
+
+		-static_cast<float>(p.angle) * Constants::DEG_TO_RAD,
+
+		static_cast<float>(p.radius),
+
+		downsample_x,
+
+		downsample_y,
+
+		SepColor::DraftCoverage(p.antialias, downsample_x, downsample_y, p.draft != 0),
+
+		static_cast<float>(p.edge_width));
+
+}
+
+// Host abort check, polled by thread 0 (see RunRenderWorker)
+static int PollAbort(void *refcon, int bands_done, int bands_total)
+
+{
+
+	(void)bands_done;
+
+	(void)bands_total;
+
+	return g_effect->abort(static_cast<OfxImageEffectHandle>(refcon)) ? kOfxStatFailed : 0;
+
+}
+
+template<typename PixelType>
+
+static void RenderThread(unsigned int thread_index, unsigned int thread_max, void *arg)
+
+{
+
+	(void)thread_max;
+
+	SepColor::RunRenderWorker(*static_cast<SepColor::RenderJob<PixelType> *>(arg), thread_index == 0);
+
+}
+
+// Incremental: the cached frame out to the host's output, in row slices
+template<typename PixelType>
+struct CopyJob
+{
+	SepColor::ImageView<PixelType> from;
+	SepColor::ImageView<PixelType> to;
+};
+
+template<typename PixelType>
+
+static void CopyThread(unsigned int thread_index, unsigned int thread_max, void *arg)
+
+{
+
+	const CopyJob<PixelType> &job = *static_cast<const CopyJob<PixelType> *>(arg);
+
+	const int y_end = static_cast<int>(static_cast<long long>(job.to.height) * (thread_index + 1) / thread_max);
+
+	for (int y = static_cast<int>(static_cast<long long>(job.to.height) * thread_index / thread_max); y < y_end; ++y)
+
+	{
+
+		std::memcpy(job.to.Row(y), job.from.Row(y), static_cast<std::size_t>(job.to.width) * sizeof(PixelType));
+
+	}
+
+}
+
+// True when `view` (cropped by ClipImage::View) is exactly the render window
+template<typename PixelType>
+
+static bool Covers(const SepColor::ImageView<PixelType> &view, const OfxRectI &window)
+
+{
+
+	return view.data != nullptr &&
+
+		view.origin_x == window.x1 && view.origin_y == window.y1 &&
+
+		view.width == window.x2 - window.x1 && view.height == window.y2 - window.y1;
+
+}
+
+template<typename PixelType>
+
+static OfxStatus RenderImage(OfxImageEffectHandle effect, const ClipImage &src, const ClipImage &dst, const OfxRectI &window, const SepColor::Geometry &geom, const RenderParams &p)
+
+{
+
+	PixelType color;
+
+	SepColor::PixelTraits<PixelType>::ConvertColorFloat(static_cast<float>(p.color[0]), static_cast<float>(p.color[1]), static_cast<float>(p.color[2]), color);
+
+	const SepColor::ImageView<const PixelType> src_view = src.View<const PixelType>(window);
+
+	const SepColor::ImageView<PixelType> dst_view = dst.View<PixelType>(window);
+
+	// The kernels read src and write dst at the same coordinates for the
+	// whole window, and View() clamps to the image: a source (or output)
+	// smaller than the window would be read past its end
+	if (!Covers(src_view, window) || !Covers(dst_view, window))
+
+	{
+
+		return kOfxStatErrImageFormat;
+
+	}
+
+	// Incremental: render into the instance's last frame, then copy it out
+	const std::string source_id = p.incremental != 0 ? SourceId(src) : std::string();
+
+	FrameCache *cache = source_id.empty() ? nullptr : InstanceCache(effect);
+
+	std::unique_lock<std::mutex> held;
+
+	if (cache != nullptr)
+
+	{
+
+		held = std::unique_lock<std::mutex>(cache->lock, std::try_to_lock);
+
+		cache = held.owns_lock() ? cache : nullptr;
+
+	}
+
+	const bool reuse = cache != nullptr && cache->Matches(source_id, window, color);
+
+	if (cache != nullptr && !reuse)
+
+	{
+
+		cache->Reset(source_id, window, color);
+
+	}
+
+	const SepColor::ImageView<PixelType> target = cache != nullptr ? cache->View<PixelType>() : dst_view;
+
+	SepColor::RenderJob<PixelType> job(src_view, target, geom, color);
+
+	job.prev_geom = reuse ? &cache->geom : nullptr;
+
+	job.poll = PollAbort;
+
+	job.poll_refcon = effect;
+
+	unsigned int threads = 1;
+
+	if (g_thread == nullptr || g_thread->multiThreadNumCPUs(&threads) != kOfxStatOK || threads < 2)
+
+	{
+
+		SepColor::RunRenderWorker(job, true);
+
+	}
+
+	else if (g_thread->multiThread(RenderThread<PixelType>, threads, &job) != kOfxStatOK)
+
+	{
+
+		job.status.store(kOfxStatFailed, std::memory_order_relaxed);
+
+	}
+
+	if (job.status.load(std::memory_order_relaxed) != 0)
+
+	{
+
+		if (cache != nullptr)
+
+		{
+
+			cache->valid = false;
+
+		}
+
+		return kOfxStatFailed;
+
+	}
+
+	if (cache != nullptr)
+
+	{
+
+		CopyJob<PixelType> copy = { target, dst_view };
+
+		if (threads < 2 || g_thread->multiThread(CopyThread<PixelType>, threads, &copy) != kOfxStatOK)
+
+		{
+
+			CopyThread<PixelType>(0, 1, &copy);
+
+		}
+
+		cache->geom = geom;
+
+		cache->valid = true;
+
+	}
+
+	return kOfxStatOK;
+
+}
+
+static OfxStatus Render(OfxImageEffectHandle effect, OfxPropertySetHandle in_args)
+
+{
+
+	SEPCOLOR_ZONE("Render");
+
+	OfxTime time = 0.0;
+
+	OfxRectI window;
+
+	OfxPointD render_scale = {1.0, 1.0};
+
+	g_prop->propGetDouble(in_args, kOfxPropTime, 0, &time);
+
+	g_prop->propGetIntN(in_args, kOfxImageEffectPropRenderWindow, 4, &window.x1);
+
+	g_prop->propGetDoubleN(in_args, kOfxImageEffectPropRenderScale, 2, &render_scale.x);
+
+	const ClipImage src(effect, kOfxImageEffectSimpleSourceClipName, time);
+
+	const ClipImage dst(effect, kOfxImageEffectOutputClipName, time);
+
+	if (src.Props() == nullptr || dst.Props() == nullptr)
+
+	{
+
+		return kOfxStatFailed;
+
+	}
+
+	char *src_depth = nullptr;
+
+	char *dst_depth = nullptr;
+
+	char *components = nullptr;
+
+	double pixel_aspect = 1.0;
+
+	g_prop->propGetString(src.Props(), kOfxImageEffectPropPixelDepth, 0, &src_depth);
+
+	g_prop->propGetString(dst.Props(), kOfxImageEffectPropPixelDepth, 0, &dst_depth);
+
+	g_prop->propGetString(dst.Props(), kOfxImageEffectPropComponents, 0, &components);
+
+	g_prop->propGetDouble(src.Props(), kOfxImagePropPixelAspectRatio, 0, &pixel_aspect);
+
+	// Source and output depths agree unless the host supports multiple
+	// clip depths, which this plugin does not ask for
+	if (src_depth == nullptr || dst_depth == nullptr || std::strcmp(src_depth, dst_depth) != 0 ||
+
+		components == nullptr || std::strcmp(components, kOfxImageComponentRGBA) != 0)
+
+	{
+
+		return kOfxStatErrImageFormat;
+
+	}
+
+	const RenderParams p = FetchParams(effect, time);
+
+	const SepColor::Geometry geom = GeometryFromParams(p, render_scale, pixel_aspect > 0.0 ? pixel_aspect : 1.0);
+
+	if (std::strcmp(dst_depth, kOfxBitDepthFloat) == 0)
+
+	{
+
+		return RenderImage<SepColor::PixelRGBA32>(effect, src, dst, window, geom, p);
+
+	}
+
+	if (std::strcmp(dst_depth, kOfxBitDepthShort) == 0)
+
+	{
+
+		return RenderImage<SepColor::PixelRGBA16>(effect, src, dst, window, geom, p);
+
+	}
+
+	if (std::strcmp(dst_depth, kOfxBitDepthByte) == 0)
+
+	{
+
+		return RenderImage<SepColor::PixelRGBA8>(effect, src, dst, window, geom, p);
+
+	}
+
+	return kOfxStatErrImageFormat;
+
+}
+
+// -------------------------------------------------------------
+
+// Entry points
+
+// -------------------------------------------------------------
+
+static void SetHost(OfxHost *host)
+
+{
+
+	g_host = host;
+
+}
+
+static OfxStatus Load()
+
+{
+
+	if (g_host == nullptr)
+
+	{
+
+		return kOfxStatErrMissingHostFeature;
+
+	}
+
+	g_prop = static_cast<const OfxPropertySuiteV1 *>(g_host->fetchSuite(g_host->host, kOfxPropertySuite, 1));
+
+	g_effect = static_cast<const OfxImageEffectSuiteV1 *>(g_host->fetchSuite(g_host->host, kOfxImageEffectSuite, 1));
+
+	g_param = static_cast<const OfxParameterSuiteV1 *>(g_host->fetchSuite(g_host->host, kOfxParameterSuite, 1));
+
+	// Optional: without it the frame renders on the calling thread
+	g_thread = static_cast<const OfxMultiThreadSuiteV1 *>(g_host->fetchSuite(g_host->host, kOfxMultiThreadSuite, 1));
+
+	SepColor::AutotuneSimdIsa(SepColor::DefaultTuneCachePath());
+
+	return g_prop != nullptr && g_effect != nullptr && g_param != nullptr ? kOfxStatOK : kOfxStatErrMissingHostFeature;
+
+}
+
+static OfxStatus MainEntry(const char *action, const void *handle, OfxPropertySetHandle in_args, OfxPropertySetHandle out_args)
+
+{
+
+	(void)out_args;
+
+	OfxImageEffectHandle effect = static_cast<OfxImageEffectHandle>(const_cast<void *>(handle));
+
+	if (std::strcmp(action, kOfxActionLoad) == 0)
+
+	{
+
+		return Load();
+
+	}
+
+	if (std::strcmp(action, kOfxActionUnload) == 0)
+
+	{
+
+#if SEPCOLOR_TRACE
+		// Trace builds only: the session's zones as Chrome trace-event JSON
+		const std::string trace_path = SepColor::detail::GetEnv("SEP_COLOR_TRACE");
+		if (!trace_path.empty())
+		{
+			SepColor::trace::WriteChromeTrace(trace_path);
+		}
+#endif
+
+		return kOfxStatOK;
+
+	}
+
+	if (std::strcmp(action, kOfxActionDescribe) == 0)
+
+	{
+
+		return Describe(effect);
+
+	}
+
+	if (std::strcmp(action, kOfxImageEffectActionDescribeInContext) == 0)
+
+	{
+
+		return DescribeInContext(effect);
+
+	}
+
+	if (std::strcmp(action, kOfxImageEffectActionRender) == 0)
+
+	{
+
+		return Render(effect, in_args);
+
+	}
+
+	if (std::strcmp(action, kOfxActionCreateInstance) == 0)
+
+	{
+
+		return CreateInstance(effect);
+
+	}
+
+	if (std::strcmp(action, kOfxActionDestroyInstance) == 0)
+
+	{
+
+		return DestroyInstance(effect);
+
+	}
+
+	return kOfxStatReplyDefault;
+
+}
+
+static OfxPlugin g_plugin = {
+
+	kOfxImageEffectPluginApi,
+
+	1,
+
+	"com.361do.sep_color",
+
+	MAJOR_VERSION,
+
+	MINOR_VERSION,
+
+	SetHost,
+
+	MainEntry
+
+};
+
+OfxExport int OfxGetNumberOfPlugins(void)
+
+{
+
+	return 1;
+
+}
+
+OfxExport OfxPlugin *OfxGetPlugin(int nth)
+
+{
+
+	return nth == 0 ? &g_plugin : nullptr;
+
+}
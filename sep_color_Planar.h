@@ -0,0 +1,592 @@
+#pragma once
+
+#ifndef SEP_COLOR_PLANAR_H
+#define SEP_COLOR_PLANAR_H
+
+// Planar processing modes for the sep_color core.
+// These work on one plane per channel, so every plane is a run of samples
+// lerped toward a constant with a shared coverage row: no interleave, no
+// per-pixel color conversion, and alpha is never read by the color math.
+
+#include "sep_color_Core.h"
+
+#include <cstdint>
+
+namespace SepColor {
+
+// Coverage rows are produced in fixed-size chunks on the stack, so the planar
+// kernels never allocate and are safe to call from any worker thread.
+
+constexpr int PLANAR_CHUNK = 512;
+
+namespace detail {
+
+template<typename SampleType>
+
+inline void CopyOrFillRun(const SampleType *in, SampleType *out, int count, RowCoverage cls, SampleType fill)
+
+{
+
+	if (cls == ROW_FULL)
+
+	{
+
+		std::fill(out, out + count, fill);
+
+	}
+
+	else if (in != out)
+
+	{
+
+		std::memcpy(out, in, static_cast<size_t>(count) * sizeof(SampleType));
+
+	}
+
+}
+
+/**
+ * Branch-free lerp of a run toward a constant. The coverage thresholds are
+ * applied as selects, so the loop auto-vectorizes and still produces exactly
+ * what ShadePixel() gives for the same coverage. Integer planes blend toward
+ * the rounded fill value with the core's fixed-point lerp (bit-exact on every
+ * machine); float planes use the PF_PixelFloat formula.
+ */
+
+template<typename SampleType>
+
+inline void LerpRun(const SampleType *in, SampleType *out, const float *cov, int count, float target, SampleType fill)
+
+{
+
+	for (int i = 0; i < count; ++i)
+
+	{
+
+		const float c = cov[i];
+
+		SampleType blended;
+
+		if constexpr (std::is_floating_point<SampleType>::value)
+
+		{
+
+			blended = in[i] + (target - in[i]) * c;
+
+		}
+
+		else
+
+		{
+
+			(void)target;
+
+			blended = BlendFixed(in[i], fill, QuantizeCoverage(c));
+
+		}
+
+		const SampleType v = c >= Constants::COVERAGE_FULL ? fill : blended;
+
+		out[i] = c <= Constants::COVERAGE_EPSILON ? in[i] : v;
+
+	}
+
+}
+
+} // namespace detail
+
+// ============================================================================
+
+// Planar R, G, B (+ optional A), one plane per channel
+
+// ============================================================================
+
+/**
+ * Structure-of-arrays frame. All planes share the layer origin of `red`.
+ * `alpha` may be empty (no alpha plane) or the same plane in src and dst,
+ * in which case it is not touched at all; otherwise it is copied row by row.
+ */
+
+template<typename SampleType>
+
+struct PlanarView
+{
+	ImageView<SampleType> red;
+	ImageView<SampleType> green;
+	ImageView<SampleType> blue;
+	ImageView<SampleType> alpha;
+
+	operator PlanarView<const SampleType>() const
+	{
+		PlanarView<const SampleType> v;
+		v.red = red;
+		v.green = green;
+		v.blue = blue;
+		v.alpha = alpha;
+		return v;
+	}
+};
+
+// Effect color in code values of the planes (e.g. 0-255, 0-32768 or 0-1)
+
+struct PlanarColor
+{
+	float red = 0.0f;
+	float green = 0.0f;
+	float blue = 0.0f;
+};
+
+template<typename SampleType>
+
+void RenderPlanarRows(
+
+	const PlanarView<const SampleType> &src,
+
+	const PlanarView<SampleType> &dst,
+
+	const Geometry &g,
+
+	const PlanarColor &color,
+
+	int y_begin,
+
+	int y_end)
+
+{
+
+	const float bias = std::is_floating_point<SampleType>::value ? 0.0f : 0.5f;
+
+	const float targets[3] = {color.red, color.green, color.blue};
+
+	const SampleType fills[3] = {
+
+		static_cast<SampleType>(color.red + bias),
+
+		static_cast<SampleType>(color.green + bias),
+
+		static_cast<SampleType>(color.blue + bias)};
+
+	const ImageView<const SampleType> *in_planes[3] = {&src.red, &src.green, &src.blue};
+
+	const ImageView<SampleType> *out_planes[3] = {&dst.red, &dst.green, &dst.blue};
+
+	const bool copy_alpha = !dst.alpha.Empty() && !src.alpha.Empty() &&
+
+		static_cast<const void *>(dst.alpha.data) != static_cast<const void *>(src.alpha.data);
+
+	const int width = dst.red.width;
+
+	const int x0 = dst.red.origin_x;
+
+	float cov[PLANAR_CHUNK];
+
+	Span spans[MAX_ROW_SPANS];
+
+	y_begin = std::max(0, y_begin);
+
+	y_end = std::min(dst.red.height, y_end);
+
+	for (int y = y_begin; y < y_end; ++y)
+
+	{
+
+		if (copy_alpha)
+
+		{
+
+			std::memcpy(dst.alpha.Row(y), src.alpha.Row(y), static_cast<size_t>(width) * sizeof(SampleType));
+
+		}
+
+		// As in RenderRows: copy / fill spans move whole runs, only the
+		// band is evaluated and lerped, in stack-sized chunks
+		const int ly = dst.red.origin_y + y;
+
+		const int n = ClassifyRow(g, ly, x0, x0 + width, spans);
+
+		for (int s = 0; s < n; ++s)
+
+		{
+
+			if (spans[s].kind != SPAN_BAND)
+
+			{
+
+				const RowCoverage cls = spans[s].kind == SPAN_FILL ? ROW_FULL : ROW_NONE;
+
+				for (int p = 0; p < 3; ++p)
+
+				{
+
+					detail::CopyOrFillRun(in_planes[p]->Row(y) + (spans[s].begin - x0), out_planes[p]->Row(y) + (spans[s].begin - x0), spans[s].end - spans[s].begin, cls, fills[p]);
+
+				}
+
+				continue;
+
+			}
+
+			for (int b = spans[s].begin; b < spans[s].end; b += PLANAR_CHUNK)
+
+			{
+
+				const int count = std::min(PLANAR_CHUNK, spans[s].end - b);
+
+				CoverageRun(g, ly, b, b + count, cov);
+
+				for (int p = 0; p < 3; ++p)
+
+				{
+
+					detail::LerpRun(in_planes[p]->Row(y) + (b - x0), out_planes[p]->Row(y) + (b - x0), cov, count, targets[p], fills[p]);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+template<typename SampleType>
+
+void RenderPlanar(const PlanarView<const SampleType> &src, const PlanarView<SampleType> &dst, const Geometry &g, const PlanarColor &color)
+
+{
+
+	RenderPlanarRows(src, dst, g, color, 0, dst.red.height);
+
+}
+
+// ============================================================================
+
+// Y'CbCr (4:4:4 / 4:2:2 / 4:2:0, 8 and 10 bit)
+
+// ============================================================================
+
+enum ChromaSubsampling
+{
+	CHROMA_444 = 0,
+	CHROMA_422,		// chroma halved horizontally
+	CHROMA_420		// chroma halved horizontally and vertically
+};
+
+enum YCbCrMatrix
+{
+	MATRIX_BT601 = 0,
+	MATRIX_BT709,
+	MATRIX_BT2020
+};
+
+struct YCbCrFormat
+{
+	ChromaSubsampling subsampling = CHROMA_420;
+	YCbCrMatrix matrix = MATRIX_BT709;
+	int bit_depth = 8;			// 8 (uint8_t samples) or 10 (uint16_t samples, low bits)
+	bool full_range = false;	// false: video range (16-235 / 16-240 at 8 bit)
+};
+
+/**
+ * Three planes of one frame. Geometry is evaluated on the luma grid, whose
+ * layer origin is y.origin_x/origin_y; for subsampled formats that origin
+ * must be even. Chroma planes are indexed from the luma position, so their
+ * own origin fields are ignored.
+ */
+
+template<typename SampleType>
+
+struct YCbCrView
+{
+	ImageView<SampleType> y;
+	ImageView<SampleType> cb;
+	ImageView<SampleType> cr;
+	YCbCrFormat format;
+
+	operator YCbCrView<const SampleType>() const
+	{
+		YCbCrView<const SampleType> v;
+		v.y = y;
+		v.cb = cb;
+		v.cr = cr;
+		v.format = format;
+		return v;
+	}
+
+	inline int ChromaShiftX() const
+	{
+		return format.subsampling == CHROMA_444 ? 0 : 1;
+	}
+
+	inline int ChromaShiftY() const
+	{
+		return format.subsampling == CHROMA_420 ? 1 : 0;
+	}
+
+	// Number of chroma rows, i.e. the work-item range for RenderYCbCrRows
+	inline int ChromaHeight() const
+	{
+		return (y.height + (1 << ChromaShiftY()) - 1) >> ChromaShiftY();
+	}
+};
+
+// Effect color in code values of the target format
+
+struct YCbCrColor
+{
+	float y = 0.0f;
+	float cb = 0.0f;
+	float cr = 0.0f;
+};
+
+/**
+ * Convert the (gamma-encoded, 0..1) effect color once per frame. The matrix
+ * is affine, so blending Y'CbCr code values with a coverage is the same as
+ * blending R'G'B' first and converting afterwards.
+ */
+
+inline YCbCrColor ColorToYCbCr(float r, float g, float b, const YCbCrFormat &format)
+
+{
+
+	float kr = 0.2126f, kb = 0.0722f;
+
+	if (format.matrix == MATRIX_BT601)
+
+	{
+
+		kr = 0.299f;
+
+		kb = 0.114f;
+
+	}
+
+	else if (format.matrix == MATRIX_BT2020)
+
+	{
+
+		kr = 0.2627f;
+
+		kb = 0.0593f;
+
+	}
+
+	const float luma = kr * r + (1.0f - kr - kb) * g + kb * b;
+
+	const float pb = (b - luma) / (2.0f * (1.0f - kb));
+
+	const float pr = (r - luma) / (2.0f * (1.0f - kr));
+
+	const float scale = static_cast<float>(1 << (format.bit_depth - 8));
+
+	YCbCrColor c;
+
+	if (format.full_range)
+
+	{
+
+		const float max_code = static_cast<float>((1 << format.bit_depth) - 1);
+
+		const float mid = static_cast<float>(1 << (format.bit_depth - 1));
+
+		c.y = luma * max_code;
+
+		c.cb = std::max(0.0f, std::min(max_code, pb * max_code + mid));
+
+		c.cr = std::max(0.0f, std::min(max_code, pr * max_code + mid));
+
+	}
+
+	else
+
+	{
+
+		c.y = (16.0f + 219.0f * luma) * scale;
+
+		c.cb = (128.0f + 224.0f * pb) * scale;
+
+		c.cr = (128.0f + 224.0f * pr) * scale;
+
+	}
+
+	return c;
+
+}
+
+/**
+ * Render chroma rows [cy_begin, cy_end) (each covers 1 or 2 luma rows).
+ * Coverage is evaluated at luma resolution; each chroma sample uses the box
+ * average of the luma coverages it spans, so the band lines up across planes.
+ * src and dst may be the same planes (in place).
+ */
+
+template<typename SampleType>
+
+void RenderYCbCrRows(
+
+	const YCbCrView<const SampleType> &src,
+
+	const YCbCrView<SampleType> &dst,
+
+	const Geometry &g,
+
+	const YCbCrColor &color,
+
+	int cy_begin,
+
+	int cy_end)
+
+{
+
+	const int sx = dst.ChromaShiftX();
+
+	const int sy = dst.ChromaShiftY();
+
+	const int rows_per_chroma = 1 << sy;
+
+	const int width = dst.y.width;
+
+	const int chroma_width = (width + (1 << sx) - 1) >> sx;
+
+	const SampleType fill_y = static_cast<SampleType>(color.y + 0.5f);
+
+	const SampleType fill_cb = static_cast<SampleType>(color.cb + 0.5f);
+
+	const SampleType fill_cr = static_cast<SampleType>(color.cr + 0.5f);
+
+	float cov[2][PLANAR_CHUNK];
+
+	float chroma_cov[PLANAR_CHUNK];
+
+	cy_begin = std::max(0, cy_begin);
+
+	cy_end = std::min(dst.ChromaHeight(), cy_end);
+
+	for (int cy = cy_begin; cy < cy_end; ++cy)
+
+	{
+
+		const int y0 = cy << sy;
+
+		const int rows = std::min(rows_per_chroma, dst.y.height - y0);
+
+		for (int x0 = 0; x0 < width; x0 += PLANAR_CHUNK)
+
+		{
+
+			const int n = std::min(PLANAR_CHUNK, width - x0);
+
+			RowCoverage cls[2] = {ROW_NONE, ROW_NONE};
+
+			// Luma: one coverage row per luma row
+
+			for (int r = 0; r < rows; ++r)
+
+			{
+
+				const int y = y0 + r;
+
+				const SampleType *in = src.y.Row(y) + x0;
+
+				SampleType *out = dst.y.Row(y) + x0;
+
+				cls[r] = CoverageRow(g, dst.y.origin_y + y, dst.y.origin_x + x0, n, cov[r]);
+
+				if (cls[r] == ROW_MIXED)
+
+				{
+
+					detail::LerpRun(in, out, cov[r], n, color.y, fill_y);
+
+				}
+
+				else
+
+				{
+
+					detail::CopyOrFillRun(in, out, n, cls[r], fill_y);
+
+				}
+
+			}
+
+			// Chroma: box-averaged luma coverage
+
+			const int cx0 = x0 >> sx;
+
+			const int cn = std::min(chroma_width - cx0, (n + (1 << sx) - 1) >> sx);
+
+			const SampleType *in_cb = src.cb.Row(cy) + cx0;
+
+			const SampleType *in_cr = src.cr.Row(cy) + cx0;
+
+			SampleType *out_cb = dst.cb.Row(cy) + cx0;
+
+			SampleType *out_cr = dst.cr.Row(cy) + cx0;
+
+			const bool uniform = rows == 1 || cls[0] == cls[1];
+
+			if (uniform && cls[0] != ROW_MIXED)
+
+			{
+
+				detail::CopyOrFillRun(in_cb, out_cb, cn, cls[0], fill_cb);
+
+				detail::CopyOrFillRun(in_cr, out_cr, cn, cls[0], fill_cr);
+
+				continue;
+
+			}
+
+			for (int i = 0; i < cn; ++i)
+
+			{
+
+				const int lx = i << sx;
+
+				const int lw = std::min(1 << sx, n - lx);
+
+				float sum = 0.0f;
+
+				for (int r = 0; r < rows; ++r)
+
+				{
+
+					for (int k = 0; k < lw; ++k)
+
+					{
+
+						sum += cov[r][lx + k];
+
+					}
+
+				}
+
+				chroma_cov[i] = sum / static_cast<float>(rows * lw);
+
+			}
+
+			detail::LerpRun(in_cb, out_cb, chroma_cov, cn, color.cb, fill_cb);
+
+			detail::LerpRun(in_cr, out_cr, chroma_cov, cn, color.cr, fill_cr);
+
+		}
+
+	}
+
+}
+
+template<typename SampleType>
+
+void RenderYCbCr(const YCbCrView<const SampleType> &src, const YCbCrView<SampleType> &dst, const Geometry &g, const YCbCrColor &color)
+
+{
+
+	RenderYCbCrRows(src, dst, g, color, 0, dst.ChromaHeight());
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_PLANAR_H
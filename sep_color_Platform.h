@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef SEP_COLOR_PLATFORM_H
+#define SEP_COLOR_PLATFORM_H
+
+// Environment and file access for the opt-in features of the core
+// (autotune cache, telemetry, trace): MSVC's checked CRT variants on
+// Windows, the plain C library elsewhere. No dependency on the rest of the
+// core, so any header can include it.
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <string>
+
+namespace SepColor {
+
+namespace detail {
+
+// Value of an environment variable, empty when unset
+inline std::string GetEnv(const char *name)
+
+{
+#if defined(_MSC_VER)
+	char *value = nullptr;
+	size_t length = 0;
+	std::string result;
+	if (_dupenv_s(&value, &length, name) == 0 && value != nullptr)
+	{
+		result = value;
+	}
+	std::free(value);
+	return result;
+#else
+	const char *value = std::getenv(name);
+	return value != nullptr ? std::string(value) : std::string();
+#endif
+}
+
+// std::fopen, or null on failure
+inline std::FILE *OpenFile(const std::string &path, const char *mode)
+
+{
+#if defined(_MSC_VER)
+	std::FILE *file = nullptr;
+	return fopen_s(&file, path.c_str(), mode) == 0 ? file : nullptr;
+#else
+	return std::fopen(path.c_str(), mode);
+#endif
+}
+
+} // namespace detail
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_PLATFORM_H
@@ -0,0 +1,323 @@
+#pragma once
+
+#ifndef SEP_COLOR_PREVIEW_H
+#define SEP_COLOR_PREVIEW_H
+
+// Frame-time budget for interactive previews.
+// On heavy comps a scrub frame matters more for its latency than for its
+// anti-aliasing, so preview renders (AE: in_data->quality == PF_Quality_LO)
+// may trade coverage quality for speed: the host reports each preview
+// frame's render time to a PreviewGovernor, which steps the level down when
+// a frame overruns the budget and back up once frames have had headroom for
+// a while. Each level down also shrinks the AA band, so it cuts kernel cost
+// and not just quality:
+//
+//   PREVIEW_FULL    the user's coverage mode (Exact Area, filter profiles)
+//   PREVIEW_LINEAR  Linear ramp, +-EDGE_WIDTH band
+//   PREVIEW_HARD    near-step ramp, +-HARD_EDGE_WIDTH band
+//
+// Final and render-queue renders never consult the governor. The level is
+// part of the coverage mode a frame renders with, so hosts keying caches on
+// RenderFingerprint() never mix degraded and full frames.
+
+#include "sep_color_Core.h"
+
+#include <atomic>
+
+#include <cstdint>
+
+namespace SepColor {
+
+enum PreviewLevel
+{
+	PREVIEW_FULL = 0,
+	PREVIEW_LINEAR,
+	PREVIEW_HARD
+};
+
+/**
+ * Coverage mode of a preview at `level`, from the mode the frame would
+ * otherwise use (after DraftCoverage). Levels never raise quality.
+ */
+
+inline int PreviewCoverage(int coverage, int level)
+
+{
+
+	if (level >= PREVIEW_HARD)
+
+	{
+
+		return COVERAGE_HARD;
+
+	}
+
+	if (level >= PREVIEW_LINEAR && coverage != COVERAGE_HARD)
+
+	{
+
+		return COVERAGE_LINEAR;
+
+	}
+
+	return coverage;
+
+}
+
+/**
+ * Budget policy of one effect instance (see PreviewGovernorMap). Lock-free
+ * and safe to call from concurrent MFR renders of that instance; a race
+ * between two reports only delays a step by a frame.
+ */
+
+class PreviewGovernor
+{
+public:
+	static constexpr float HEADROOM = 0.5f;			// step up only below this fraction of the budget
+	static constexpr int PATIENCE = 4;				// calm frames before a step up
+	static constexpr int MAX_PATIENCE = 64;			// after repeated failed step ups
+
+	// Back to full quality with no history, for a reused slot
+	void Reset()
+	{
+		level_.store(PREVIEW_FULL, std::memory_order_relaxed);
+
+		calm_.store(0, std::memory_order_relaxed);
+
+		patience_.store(PATIENCE, std::memory_order_relaxed);
+
+		probing_.store(false, std::memory_order_relaxed);
+	}
+
+	// Level for the next preview frame
+	int Level() const
+	{
+		return level_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Report a preview frame rendered at `level` in `ms`. A budget <= 0
+	 * turns the policy off and restores full quality.
+	 */
+	void Report(int level, float ms, float budget_ms)
+	{
+		if (budget_ms <= 0.0f)
+
+		{
+
+			level_.store(PREVIEW_FULL, std::memory_order_relaxed);
+
+			calm_.store(0, std::memory_order_relaxed);
+
+			return;
+
+		}
+
+		// Frames started before the last step say nothing about this level
+		int current = level;
+
+		if (ms > budget_ms)
+
+		{
+
+			calm_.store(0, std::memory_order_relaxed);
+
+			if (current < PREVIEW_HARD && level_.compare_exchange_strong(current, current + 1, std::memory_order_relaxed))
+
+			{
+
+				// Overrunning right after a step up: wait longer before the next
+				if (probing_.exchange(false, std::memory_order_relaxed))
+
+				{
+
+					patience_.store(std::min(2 * patience_.load(std::memory_order_relaxed), MAX_PATIENCE), std::memory_order_relaxed);
+
+				}
+
+			}
+
+			return;
+
+		}
+
+		if (level != level_.load(std::memory_order_relaxed))
+
+		{
+
+			return;
+
+		}
+
+		if (probing_.exchange(false, std::memory_order_relaxed))
+
+		{
+
+			// The step up held
+			patience_.store(PATIENCE, std::memory_order_relaxed);
+
+		}
+
+		if (level == PREVIEW_FULL || ms > budget_ms * HEADROOM)
+
+		{
+
+			calm_.store(0, std::memory_order_relaxed);
+
+			return;
+
+		}
+
+		if (calm_.fetch_add(1, std::memory_order_relaxed) + 1 >= patience_.load(std::memory_order_relaxed) &&
+			level_.compare_exchange_strong(current, current - 1, std::memory_order_relaxed))
+
+		{
+
+			calm_.store(0, std::memory_order_relaxed);
+
+			probing_.store(true, std::memory_order_relaxed);
+
+		}
+	}
+
+private:
+	std::atomic<int> level_{PREVIEW_FULL};
+	std::atomic<int> calm_{0};						// consecutive frames under HEADROOM
+	std::atomic<int> patience_{PATIENCE};
+	std::atomic<bool> probing_{false};				// first frames after a step up
+};
+
+/**
+ * One PreviewGovernor per effect instance, so a heavy instance degrades
+ * only its own previews. The key is a nonzero id the host keeps with the
+ * instance (AE: its sequence data). Acquire() and Release() pair up with
+ * the instance's setup and setdown, so every live copy of the instance
+ * holds a reference; the last release frees the slot for reuse.
+ *
+ * A fixed table of slots: Find() on the render path is a lock-free scan
+ * and nothing is ever allocated. Ids without a slot (more than CAPACITY
+ * live instances, or hosts without sequence data) share one fallback
+ * governor. Acquire / Release must come from one thread at a time (AE's
+ * UI thread); Find() is safe from any render thread. A render that races a
+ * release at worst steers the next preview level of a reused slot.
+ */
+
+class PreviewGovernorMap
+{
+public:
+	static constexpr int CAPACITY = 256;
+
+	void Acquire(std::uint64_t key)
+	{
+		if (key == 0)
+
+		{
+
+			return;
+
+		}
+
+		Slot *free_slot = nullptr;
+
+		for (Slot &slot : slots_)
+
+		{
+
+			const std::uint64_t slot_key = slot.key.load(std::memory_order_acquire);
+
+			if (slot_key == key)
+
+			{
+
+				slot.refs.fetch_add(1, std::memory_order_relaxed);
+
+				return;
+
+			}
+
+			if (slot_key == 0 && free_slot == nullptr)
+
+			{
+
+				free_slot = &slot;
+
+			}
+
+		}
+
+		if (free_slot != nullptr)
+
+		{
+
+			free_slot->governor.Reset();
+
+			free_slot->refs.store(1, std::memory_order_relaxed);
+
+			free_slot->key.store(key, std::memory_order_release);
+
+		}
+	}
+
+	void Release(std::uint64_t key)
+	{
+		Slot *slot = FindSlot(key);
+
+		if (slot != nullptr && slot->refs.fetch_sub(1, std::memory_order_relaxed) == 1)
+
+		{
+
+			slot->key.store(0, std::memory_order_release);
+
+		}
+	}
+
+	// Governor of `key`, or the shared fallback; once per frame, not per row
+	PreviewGovernor &Find(std::uint64_t key)
+	{
+		Slot *slot = FindSlot(key);
+
+		return slot != nullptr ? slot->governor : shared_;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<std::uint64_t> key{0};			// 0: free
+		std::atomic<int> refs{0};
+		PreviewGovernor governor;
+	};
+
+	Slot *FindSlot(std::uint64_t key)
+	{
+		if (key == 0)
+
+		{
+
+			return nullptr;
+
+		}
+
+		for (Slot &slot : slots_)
+
+		{
+
+			if (slot.key.load(std::memory_order_acquire) == key)
+
+			{
+
+				return &slot;
+
+			}
+
+		}
+
+		return nullptr;
+	}
+
+	Slot slots_[CAPACITY];
+	PreviewGovernor shared_;
+};
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_PREVIEW_H
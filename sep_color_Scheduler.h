@@ -0,0 +1,419 @@
+#pragma once
+
+#ifndef SEP_COLOR_SCHEDULER_H
+#define SEP_COLOR_SCHEDULER_H
+
+// Host-neutral parallel render jobs for the sep_color core.
+// The core never creates threads: the host calls RunRenderWorker() from
+// each of its own worker threads (AE: PF_Iterate8Suite1::iterate_generic
+// with PF_Iterations_ONCE_PER_PROCESSOR), and the workers pull row bands
+// from a shared atomic counter until the frame is done. Whichever thread
+// renders a band, its pixels are computed the same way, so the output does
+// not depend on the thread count.
+//
+// Rows are not equally expensive: a row through the AA band costs several
+// times a pure copy or fill row. Bands are therefore cut to equal estimated
+// cost rather than equal height, and handed out dynamically so estimation
+// error is absorbed by whichever worker is free.
+//
+// Cancellation and progress are cooperative and band-grained: one worker
+// (AE: thread 0, the only one allowed to call PF_ABORT / PF_PROGRESS)
+// polls the host between slices of its own bands and whenever any other
+// worker finishes a band, and every worker checks the job's status before
+// taking its next band. With a few hundred polls per frame at most the
+// overhead is lost in the noise, while a cancel lands within about one
+// band's render time.
+
+#include "sep_color_Core.h"
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <thread>
+
+namespace SepColor {
+
+// Per-row cost model, roughly nanoseconds on a current desktop core
+// (calibrated on UHD frames). Copy and fill spans are bound by memory
+// traffic; band pixels add their coverage and blend arithmetic on top.
+
+namespace Cost {
+
+	constexpr float PER_BYTE = 0.2f;			// copy / fill / band memory traffic
+
+	constexpr float BAND_PIXEL = 1.5f;			// Linear, Exact Area
+
+	constexpr float BAND_PIXEL_LUT = 6.0f;		// Box .. Smoothstep
+
+	constexpr float PER_ROW = 50.0f;			// classification and loop setup
+
+} // namespace Cost
+
+inline float EstimateRowCost(const Geometry &g, int y, int x_begin, int x_end, int bytes_per_pixel)
+
+{
+
+	Span spans[MAX_ROW_SPANS];
+
+	const int n = ClassifyRow(g, y, x_begin, x_end, spans);
+
+	const float band_px_cost = g.coverage >= COVERAGE_BOX ? Cost::BAND_PIXEL_LUT : Cost::BAND_PIXEL;
+
+	float cost = Cost::PER_ROW + static_cast<float>(x_end - x_begin) * static_cast<float>(bytes_per_pixel) * Cost::PER_BYTE;
+
+	for (int s = 0; s < n; ++s)
+
+	{
+
+		if (spans[s].kind == SPAN_BAND)
+
+		{
+
+			cost += static_cast<float>(spans[s].end - spans[s].begin) * band_px_cost;
+
+		}
+
+	}
+
+	return cost;
+
+}
+
+/**
+ * Host poll: report progress in bands and return nonzero to stop the frame.
+ * The value is kept as RenderJob::status for the host to hand back.
+ */
+
+typedef int (*RenderPollFn)(void *refcon, int bands_done, int bands_total);
+
+/**
+ * One frame, split into at most MAX_BANDS bands of about equal estimated
+ * cost: band b covers rows [band_begin[b], band_begin[b + 1]). Lives on the
+ * host's render stack for the duration of the parallel call; the workers
+ * only read it, apart from the band counter.
+ */
+
+template<typename PixelType>
+struct RenderJob
+{
+	static constexpr int MAX_BANDS = 128;			// ~8 per worker on 16 cores
+	static constexpr int MIN_BAND_ROWS = 4;
+	static constexpr int COST_SAMPLES = 256;		// rows sampled by the cost model
+	static constexpr int POLL_SLICES = 4;			// polls per band of the polling worker
+
+	ImageView<const PixelType> src;
+	ImageView<PixelType> dst;
+	const Geometry *geom = nullptr;
+	const Geometry *prev_geom = nullptr;			// incremental: dst holds the frame rendered with it
+	PixelType color;
+	int bands = 0;
+	int band_begin[MAX_BANDS + 1] = {};
+	std::atomic<int> next_band{0};
+	std::atomic<int> bands_done{0};
+	std::atomic<int> status{0};						// first nonzero poll result
+	RenderPollFn poll = nullptr;
+	void *poll_refcon = nullptr;
+	bool collect_stats = false;						// telemetry: fill `stats` (full renders only)
+	std::atomic<std::uint64_t> stats[RenderStats::COUNTERS] = {};
+
+	RenderJob(const ImageView<const PixelType> &src_, const ImageView<PixelType> &dst_, const Geometry &geom_, const PixelType &color_)
+		: src(src_), dst(dst_), geom(&geom_), color(color_)
+	{
+		Partition();
+	}
+
+	RenderJob(const RenderJob &) = delete;
+	RenderJob &operator=(const RenderJob &) = delete;
+
+	// Totals of all workers; valid once the parallel call has returned
+	RenderStats Stats() const
+	{
+		RenderStats totals;
+
+		for (int c = 0; c < RenderStats::COUNTERS; ++c)
+
+		{
+
+			totals.value[c] = stats[c].load(std::memory_order_relaxed);
+
+		}
+
+		return totals;
+	}
+
+	/**
+	 * Cut the rows into bands of equal estimated cost. The model is sampled
+	 * on up to COST_SAMPLES evenly spaced rows, each standing for the rows
+	 * around it, so setup stays a few microseconds even on 30000-row frames.
+	 */
+	void Partition()
+	{
+		SEPCOLOR_ZONE("Partition");
+
+		const int h = dst.height;
+
+		bands = 0;
+
+		band_begin[0] = 0;
+
+		if (h <= 0)
+
+		{
+
+			return;
+
+		}
+
+		const int samples = std::min(h, COST_SAMPLES);
+
+		float row_cost[COST_SAMPLES];
+
+		float total = 0.0f;
+
+		for (int s = 0; s < samples; ++s)
+
+		{
+
+			const int r0 = static_cast<int>(static_cast<long long>(s) * h / samples);
+
+			const int r1 = static_cast<int>(static_cast<long long>(s + 1) * h / samples);
+
+			row_cost[s] = EstimateRowCost(*geom, dst.origin_y + (r0 + r1) / 2, dst.origin_x, dst.origin_x + dst.width, static_cast<int>(sizeof(PixelType)));
+
+			total += row_cost[s] * static_cast<float>(r1 - r0);
+
+		}
+
+		const int target = std::max(1, std::min(MAX_BANDS, h / MIN_BAND_ROWS));
+
+		const float per_band = total / static_cast<float>(target);
+
+		// Walk the sampled ranges, cutting wherever the running cost crosses
+		// the next multiple of per_band (rows in a range cost the same).
+		// Cuts that would leave a band thinner than MIN_BAND_ROWS are dropped.
+		float acc = 0.0f;
+
+		int last = 0;
+
+		int quantum = 1;
+
+		for (int s = 0; s < samples && quantum < target; ++s)
+
+		{
+
+			const int r0 = static_cast<int>(static_cast<long long>(s) * h / samples);
+
+			const int r1 = static_cast<int>(static_cast<long long>(s + 1) * h / samples);
+
+			const float range_end = acc + row_cost[s] * static_cast<float>(r1 - r0);
+
+			while (quantum < target && range_end >= per_band * static_cast<float>(quantum))
+
+			{
+
+				const float into = (per_band * static_cast<float>(quantum) - acc) / row_cost[s];
+
+				const int cut = std::min(r1, r0 + static_cast<int>(into));
+
+				if (cut - last >= MIN_BAND_ROWS && h - cut >= MIN_BAND_ROWS)
+
+				{
+
+					band_begin[++bands] = cut;
+
+					last = cut;
+
+				}
+
+				++quantum;
+
+			}
+
+			acc = range_end;
+
+		}
+
+		band_begin[++bands] = h;
+
+	}
+};
+
+namespace detail {
+
+// Ask the host whether to stop; a nonzero answer stops every worker
+template<typename PixelType>
+
+inline void PollJob(RenderJob<PixelType> &job, int done)
+
+{
+
+	const int status = job.poll(job.poll_refcon, done, job.bands);
+
+	if (status != 0)
+
+	{
+
+		job.status.store(status, std::memory_order_relaxed);
+
+	}
+
+}
+
+} // namespace detail
+
+/**
+ * Body of one host worker: render bands until none are left or the host
+ * asked to stop. Safe to call from any number of threads at once, including
+ * just one; pass `polls` to exactly one of them.
+ *
+ * The polling worker renders its own bands in POLL_SLICES slices with a poll
+ * after each, and once no band is left for it, polls again whenever another
+ * worker finishes one, until the frame is done. A cancel is therefore seen
+ * within about a band's render time however the host schedules thread 0,
+ * including when it starts after the other workers took every band.
+ */
+
+template<typename PixelType>
+
+void RunRenderWorker(RenderJob<PixelType> &job, bool polls = false)
+
+{
+
+	SEPCOLOR_ZONE("Worker");
+
+	// On this worker's stack: bound to the thread for the whole frame, and
+	// nothing to allocate whichever threads the host runs us on
+	RowScratch scratch;
+
+	RenderStats local;
+
+	RenderStats *stats = job.collect_stats ? &local : nullptr;
+
+	polls = polls && job.poll != nullptr;
+
+	const auto render = [&](int y0, int y1) {
+
+		if (job.prev_geom != nullptr)
+
+		{
+
+			RenderRowsDelta(job.src, job.dst, *job.prev_geom, *job.geom, job.color, y0, y1, scratch);
+
+			return;
+
+		}
+
+		RenderRows(job.src, job.dst, *job.geom, job.color, y0, y1, scratch, stats);
+
+	};
+
+	while (job.status.load(std::memory_order_relaxed) == 0)
+
+	{
+
+		const int band = job.next_band.fetch_add(1, std::memory_order_relaxed);
+
+		if (band >= job.bands)
+
+		{
+
+			break;
+
+		}
+
+		SEPCOLOR_ZONE("Band");
+
+		const int y_begin = job.band_begin[band];
+
+		const int y_end = job.band_begin[band + 1];
+
+		if (!polls)
+
+		{
+
+			render(y_begin, y_end);
+
+			job.bands_done.fetch_add(1, std::memory_order_relaxed);
+
+			continue;
+
+		}
+
+		const int slice = std::max(1, (y_end - y_begin + RenderJob<PixelType>::POLL_SLICES - 1) / RenderJob<PixelType>::POLL_SLICES);
+
+		for (int y = y_begin; y < y_end; y += slice)
+
+		{
+
+			render(y, std::min(y_end, y + slice));
+
+			const bool last = y + slice >= y_end;
+
+			const int done = last ? job.bands_done.fetch_add(1, std::memory_order_relaxed) + 1 : job.bands_done.load(std::memory_order_relaxed);
+
+			detail::PollJob(job, done);
+
+			if (!last && job.status.load(std::memory_order_relaxed) != 0)
+
+			{
+
+				break;
+
+			}
+
+		}
+
+	}
+
+	// Every band is taken; keep the host's cancel reachable while the other
+	// workers finish theirs
+	for (int seen = -1; polls && job.status.load(std::memory_order_relaxed) == 0;)
+
+	{
+
+		const int done = job.bands_done.load(std::memory_order_relaxed);
+
+		if (done >= job.bands)
+
+		{
+
+			break;
+
+		}
+
+		if (done != seen)
+
+		{
+
+			seen = done;
+
+			detail::PollJob(job, done);
+
+			continue;
+
+		}
+
+		std::this_thread::yield();
+
+	}
+
+	if (stats != nullptr)
+
+	{
+
+		for (int c = 0; c < RenderStats::COUNTERS; ++c)
+
+		{
+
+			job.stats[c].fetch_add(local.value[c], std::memory_order_relaxed);
+
+		}
+
+	}
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_SCHEDULER_H
@@ -0,0 +1,360 @@
+#pragma once
+
+#ifndef SEP_COLOR_SIMD_H
+#define SEP_COLOR_SIMD_H
+
+// Thin SIMD vector layer for the sep_color core.
+// Kernels are written once against the interface below (see
+// sep_color_SimdKernels.h) and compiled once per ISA inside a target region,
+// so a new kernel gets SSE4.1 / AVX2 / AVX-512 / NEON without new code.
+//
+// Every operation is an exact IEEE lane-wise op (no FMA, no reciprocal
+// estimates), and Min / Max / Select follow the scalar std:: semantics, so
+// each backend produces the same bits as the scalar reference.
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <cmath>
+
+#include <cstdint>
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SEPCOLOR_SIMD_NEON 1
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SEPCOLOR_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Target regions: every function defined between BEGIN and END is compiled
+// for the given ISA. MSVC needs none, its intrinsics are always available.
+#define SEPCOLOR_SIMD_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define SEPCOLOR_TARGET_BEGIN(isa) SEPCOLOR_SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define SEPCOLOR_TARGET_END SEPCOLOR_SIMD_PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+#define SEPCOLOR_TARGET_BEGIN(isa) SEPCOLOR_SIMD_PRAGMA(GCC push_options) SEPCOLOR_SIMD_PRAGMA(GCC target(isa))
+#define SEPCOLOR_TARGET_END SEPCOLOR_SIMD_PRAGMA(GCC pop_options)
+#else
+#define SEPCOLOR_TARGET_BEGIN(isa)
+#define SEPCOLOR_TARGET_END
+#endif
+
+namespace SepColor {
+
+enum SimdIsa
+{
+	SIMD_SCALAR = 0,
+	SIMD_SSE41,
+	SIMD_AVX2,
+	SIMD_AVX512,		// AVX-512F
+	SIMD_NEON
+};
+
+namespace simd {
+
+// ------------------------------------------------------------
+// Scalar reference backend (one lane)
+// ------------------------------------------------------------
+
+struct Scalar
+{
+	using F = float;
+	using M = bool;
+	static constexpr int WIDTH = 1;
+
+	static inline F Set1(float v) { return v; }
+	static inline F Iota() { return 0.0f; }
+	static inline F Load(const float *p) { return *p; }
+	static inline void Store(float *p, F v) { *p = v; }
+	static inline void StoreTrunc(std::int32_t *p, F v) { *p = static_cast<std::int32_t>(v); }
+
+	static inline F Add(F a, F b) { return a + b; }
+	static inline F Sub(F a, F b) { return a - b; }
+	static inline F Mul(F a, F b) { return a * b; }
+	static inline F Div(F a, F b) { return a / b; }
+	static inline F Sqrt(F a) { return sqrtf(a); }
+	static inline F Abs(F a) { return std::fabs(a); }
+	static inline F Min(F a, F b) { return std::min(a, b); }
+	static inline F Max(F a, F b) { return std::max(a, b); }
+
+	static inline M Lt(F a, F b) { return a < b; }
+	static inline M Le(F a, F b) { return a <= b; }
+	static inline M Ge(F a, F b) { return a >= b; }
+	static inline F Select(M m, F a, F b) { return m ? a : b; }
+
+	// a + (b - a) * t, the blend every float path uses
+	static inline F Lerp(F a, F b, F t) { return Add(a, Mul(Sub(b, a), t)); }
+};
+
+#if defined(SEPCOLOR_SIMD_X86)
+
+// ------------------------------------------------------------
+// SSE4.1, 4 lanes
+// ------------------------------------------------------------
+
+SEPCOLOR_TARGET_BEGIN("sse4.1")
+
+struct Sse41
+{
+	using F = __m128;
+	using M = __m128;
+	static constexpr int WIDTH = 4;
+
+	static inline F Set1(float v) { return _mm_set1_ps(v); }
+	static inline F Iota() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+	static inline F Load(const float *p) { return _mm_loadu_ps(p); }
+	static inline void Store(float *p, F v) { _mm_storeu_ps(p, v); }
+	static inline void StoreTrunc(std::int32_t *p, F v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvttps_epi32(v)); }
+
+	static inline F Add(F a, F b) { return _mm_add_ps(a, b); }
+	static inline F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+	static inline F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+	static inline F Div(F a, F b) { return _mm_div_ps(a, b); }
+	static inline F Sqrt(F a) { return _mm_sqrt_ps(a); }
+	static inline F Abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	// minps/maxps return their second operand on ties, std::min/max the first
+	static inline F Min(F a, F b) { return _mm_min_ps(b, a); }
+	static inline F Max(F a, F b) { return _mm_max_ps(b, a); }
+
+	static inline M Lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+	static inline M Le(F a, F b) { return _mm_cmple_ps(a, b); }
+	static inline M Ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+	static inline F Select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+
+	static inline F Lerp(F a, F b, F t) { return Add(a, Mul(Sub(b, a), t)); }
+};
+
+SEPCOLOR_TARGET_END
+
+// ------------------------------------------------------------
+// AVX2, 8 lanes (FMA deliberately not enabled)
+// ------------------------------------------------------------
+
+SEPCOLOR_TARGET_BEGIN("avx2")
+
+struct Avx2
+{
+	using F = __m256;
+	using M = __m256;
+	static constexpr int WIDTH = 8;
+
+	static inline F Set1(float v) { return _mm256_set1_ps(v); }
+	static inline F Iota() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+	static inline F Load(const float *p) { return _mm256_loadu_ps(p); }
+	static inline void Store(float *p, F v) { _mm256_storeu_ps(p, v); }
+	static inline void StoreTrunc(std::int32_t *p, F v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm256_cvttps_epi32(v)); }
+
+	static inline F Add(F a, F b) { return _mm256_add_ps(a, b); }
+	static inline F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+	static inline F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+	static inline F Div(F a, F b) { return _mm256_div_ps(a, b); }
+	static inline F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+	static inline F Abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	static inline F Min(F a, F b) { return _mm256_min_ps(b, a); }
+	static inline F Max(F a, F b) { return _mm256_max_ps(b, a); }
+
+	static inline M Lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline M Le(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static inline M Ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline F Select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+
+	static inline F Lerp(F a, F b, F t) { return Add(a, Mul(Sub(b, a), t)); }
+};
+
+SEPCOLOR_TARGET_END
+
+// ------------------------------------------------------------
+// AVX-512F, 16 lanes. AVX-512F implies FMA, which is why GCC builds
+// must pass -ffp-contract=off (see sep_color_Core.h).
+// ------------------------------------------------------------
+
+SEPCOLOR_TARGET_BEGIN("avx512f")
+
+struct Avx512
+{
+	using F = __m512;
+	using M = __mmask16;
+	static constexpr int WIDTH = 16;
+
+	static inline F Set1(float v) { return _mm512_set1_ps(v); }
+	static inline F Iota() { return _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f); }
+	static inline F Load(const float *p) { return _mm512_loadu_ps(p); }
+	static inline void Store(float *p, F v) { _mm512_storeu_ps(p, v); }
+	static inline void StoreTrunc(std::int32_t *p, F v) { _mm512_storeu_si512(p, _mm512_cvttps_epi32(v)); }
+
+	static inline F Add(F a, F b) { return _mm512_add_ps(a, b); }
+	static inline F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+	static inline F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+	static inline F Div(F a, F b) { return _mm512_div_ps(a, b); }
+	static inline F Sqrt(F a) { return _mm512_sqrt_ps(a); }
+	static inline F Abs(F a) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_set1_epi32(0x7FFFFFFF))); }
+	static inline F Min(F a, F b) { return _mm512_min_ps(b, a); }
+	static inline F Max(F a, F b) { return _mm512_max_ps(b, a); }
+
+	static inline M Lt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	static inline M Le(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+	static inline M Ge(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+	static inline F Select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+
+	static inline F Lerp(F a, F b, F t) { return Add(a, Mul(Sub(b, a), t)); }
+};
+
+SEPCOLOR_TARGET_END
+
+#endif // SEPCOLOR_SIMD_X86
+
+#if defined(SEPCOLOR_SIMD_NEON)
+
+// ------------------------------------------------------------
+// NEON (AArch64), 4 lanes. fmin/fmax treat signed zeros differently from
+// std::min/max, so Min/Max are compare + select.
+// ------------------------------------------------------------
+
+struct Neon
+{
+	using F = float32x4_t;
+	using M = uint32x4_t;
+	static constexpr int WIDTH = 4;
+
+	static inline F Set1(float v) { return vdupq_n_f32(v); }
+	static inline F Iota() { const float v[4] = {0.0f, 1.0f, 2.0f, 3.0f}; return vld1q_f32(v); }
+	static inline F Load(const float *p) { return vld1q_f32(p); }
+	static inline void Store(float *p, F v) { vst1q_f32(p, v); }
+	static inline void StoreTrunc(std::int32_t *p, F v) { vst1q_s32(p, vcvtq_s32_f32(v)); }
+
+	static inline F Add(F a, F b) { return vaddq_f32(a, b); }
+	static inline F Sub(F a, F b) { return vsubq_f32(a, b); }
+	static inline F Mul(F a, F b) { return vmulq_f32(a, b); }
+	static inline F Div(F a, F b) { return vdivq_f32(a, b); }
+	static inline F Sqrt(F a) { return vsqrtq_f32(a); }
+	static inline F Abs(F a) { return vabsq_f32(a); }
+	static inline F Min(F a, F b) { return vbslq_f32(vcltq_f32(b, a), b, a); }
+	static inline F Max(F a, F b) { return vbslq_f32(vcltq_f32(a, b), b, a); }
+
+	static inline M Lt(F a, F b) { return vcltq_f32(a, b); }
+	static inline M Le(F a, F b) { return vcleq_f32(a, b); }
+	static inline M Ge(F a, F b) { return vcgeq_f32(a, b); }
+	static inline F Select(M m, F a, F b) { return vbslq_f32(m, a, b); }
+
+	static inline F Lerp(F a, F b, F t) { return Add(a, Mul(Sub(b, a), t)); }
+};
+
+#endif // SEPCOLOR_SIMD_NEON
+
+} // namespace simd
+
+// ------------------------------------------------------------
+// Runtime ISA selection
+// ------------------------------------------------------------
+
+// Best ISA this CPU and OS support (no caching)
+
+inline SimdIsa DetectSimdIsa()
+
+{
+#if defined(SEPCOLOR_SIMD_NEON)
+	return SIMD_NEON;
+#elif defined(SEPCOLOR_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	const int max_leaf = info[0];
+	__cpuid(info, 1);
+	const bool sse41 = (info[2] & (1 << 19)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool avx2 = false, avx512 = false;
+	if (max_leaf >= 7 && avx && (xcr0 & 0x6) == 0x6)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+		avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+	}
+	return avx512 ? SIMD_AVX512 : (avx2 ? SIMD_AVX2 : (sse41 ? SIMD_SSE41 : SIMD_SCALAR));
+#elif defined(SEPCOLOR_SIMD_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		return SIMD_AVX512;
+	}
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return SIMD_AVX2;
+	}
+	return __builtin_cpu_supports("sse4.1") ? SIMD_SSE41 : SIMD_SCALAR;
+#else
+	return SIMD_SCALAR;
+#endif
+}
+
+namespace detail {
+
+// -1 until first use. An atomic rather than a function-local static: the
+// Mac project builds without thread-safe statics.
+inline std::atomic<int> g_simd_isa{-1};
+
+} // namespace detail
+
+inline SimdIsa ActiveSimdIsa()
+
+{
+
+	int isa = detail::g_simd_isa.load(std::memory_order_relaxed);
+
+	if (isa < 0)
+
+	{
+
+		isa = DetectSimdIsa(); // racing threads store the same value
+
+		detail::g_simd_isa.store(isa, std::memory_order_relaxed);
+
+	}
+
+	return static_cast<SimdIsa>(isa);
+
+}
+
+/**
+ * Pin the kernels to one ISA, e.g. to compare every backend against the
+ * scalar reference. Requests the CPU cannot run fall back to the best one
+ * it can; returns the ISA actually selected.
+ */
+
+inline SimdIsa SetSimdIsa(SimdIsa isa)
+
+{
+
+	const SimdIsa best = DetectSimdIsa();
+
+	if (isa != SIMD_SCALAR && (isa == SIMD_NEON) != (best == SIMD_NEON))
+
+	{
+
+		isa = best;
+
+	}
+
+	else if (isa > best)
+
+	{
+
+		isa = best;
+
+	}
+
+	detail::g_simd_isa.store(isa, std::memory_order_relaxed);
+
+	return isa;
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_SIMD_H
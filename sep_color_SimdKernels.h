@@ -0,0 +1,367 @@
+// SIMD kernels for the sep_color core, written once against the vector
+// interface of sep_color_Simd.h.
+//
+// No include guard on purpose: sep_color_Core.h includes this file once per
+// ISA, inside a namespace that defines `V` (the backend) and inside that
+// ISA's target region. Each kernel must give the same bits as its scalar
+// reference in sep_color_Core.h, so keep the operation order identical.
+
+// SquareCoverage() across lanes; branches become selects in reverse order
+
+inline V::F SquareCoverageV(V::F d, V::F a, V::F b)
+
+{
+
+	const V::F half = V::Set1(0.5f);
+
+	const V::F h = V::Mul(V::Add(a, b), half);
+
+	const V::F k = V::Mul(V::Sub(a, b), half);
+
+	const V::F denom = V::Mul(V::Mul(V::Set1(2.0f), a), b);
+
+	const V::F lo = V::Add(d, h);
+
+	const V::F hi = V::Sub(h, d);
+
+	V::F r = V::Add(half, V::Div(d, a));
+
+	r = V::Select(V::Ge(d, k), V::Sub(V::Set1(1.0f), V::Div(V::Mul(hi, hi), denom)), r);
+
+	r = V::Select(V::Le(d, V::Sub(V::Set1(0.0f), k)), V::Div(V::Mul(lo, lo), denom), r);
+
+	r = V::Select(V::Ge(d, h), V::Set1(1.0f), r);
+
+	return V::Select(V::Le(d, V::Sub(V::Set1(0.0f), h)), V::Set1(0.0f), r);
+
+}
+
+// LUT profiles gather per lane; the signed distance is already in out[]
+
+inline void LookupTile(const Geometry &g, float *out)
+
+{
+
+	for (int i = 0; i < Constants::COORD_TILE; ++i)
+
+	{
+
+		const float sd = out[i];
+
+		out[i] = sd <= -g.edge_width ? 0.0f : (sd >= g.edge_width ? 1.0f : g.lut.Lookup(sd));
+
+	}
+
+}
+
+/**
+ * TileCoverage() for all COORD_TILE pixels of a tile frame.
+ */
+
+inline void CoverageTile(const Geometry &g, const TileFrame &f, float *out)
+
+{
+
+	const V::F ew = V::Set1(g.edge_width);
+
+	const V::F neg_ew = V::Set1(-g.edge_width);
+
+	const V::F zero = V::Set1(0.0f);
+
+	const V::F one = V::Set1(1.0f);
+
+	const V::F half = V::Set1(0.5f);
+
+	const bool lut = g.coverage >= COVERAGE_BOX;
+
+	for (int i = 0; i < Constants::COORD_TILE; i += V::WIDTH)
+
+	{
+
+		const V::F fi = V::Add(V::Iota(), V::Set1(static_cast<float>(i)));
+
+		V::F sd, r;
+
+		if (g.mode == MODE_LINE)
+
+		{
+
+			sd = V::Add(V::Set1(f.base), V::Mul(V::Set1(f.step), fi));
+
+			if (lut)
+
+			{
+
+				V::Store(out + i, sd);
+
+				continue;
+
+			}
+
+			if (g.coverage == COVERAGE_AREA)
+
+			{
+
+				r = SquareCoverageV(V::Mul(sd, V::Set1(g.area_inv_len)), V::Set1(g.area_a), V::Set1(g.area_b));
+
+			}
+
+			else
+
+			{
+
+				r = V::Mul(V::Add(V::Mul(sd, V::Set1(g.inv_edge_width)), one), half);
+
+			}
+
+		}
+
+		else
+
+		{
+
+			const V::F ox = V::Mul(V::Set1(f.step), fi);
+
+			const V::F e = V::Sub(V::Set1(f.base), V::Mul(V::Add(V::Set1(f.dx2), ox), ox));
+
+			const V::F dist = V::Sqrt(V::Max(zero, V::Sub(V::Set1(g.radius * g.radius), e)));
+
+			sd = V::Div(e, V::Max(V::Add(V::Set1(g.radius), dist), V::Set1(1e-12f)));
+
+			if (lut)
+
+			{
+
+				V::Store(out + i, sd);
+
+				continue;
+
+			}
+
+			if (g.coverage == COVERAGE_AREA)
+
+			{
+
+				const V::F gx = V::Mul(V::Abs(V::Add(V::Set1(f.dx2 * 0.5f), ox)), V::Set1(g.downsample_x));
+
+				const V::F gy = V::Set1(std::fabs(f.dy) * g.downsample_y);
+
+				const V::F len = V::Max(V::Sqrt(V::Add(V::Mul(gx, gx), V::Mul(gy, gy))), V::Set1(1e-12f));
+
+				r = SquareCoverageV(V::Div(V::Mul(sd, dist), len), V::Div(V::Max(gx, gy), len), V::Div(V::Min(gx, gy), len));
+
+				const float center = SquareCoverage(g.radius / std::max(g.downsample_x, g.downsample_y), 1.0f, 0.0f);
+
+				r = V::Select(V::Lt(dist, V::Set1(1e-6f)), V::Set1(center), r);
+
+			}
+
+			else
+
+			{
+
+				r = V::Max(zero, V::Min(one, V::Mul(V::Add(V::Mul(sd, V::Set1(g.inv_edge_width)), one), half)));
+
+			}
+
+		}
+
+		r = V::Select(V::Ge(sd, ew), one, r);
+
+		V::Store(out + i, V::Select(V::Le(sd, neg_ew), zero, r));
+
+	}
+
+	if (lut)
+
+	{
+
+		LookupTile(g, out);
+
+	}
+
+}
+
+/**
+ * CoverageRun() body: layer pixels [x_begin, x_end) of row y into cov[].
+ */
+
+inline void CoverageRun(const Geometry &g, int y, int x_begin, int x_end, float *cov)
+
+{
+
+	float tile[Constants::COORD_TILE];
+
+	int x = x_begin;
+
+	while (x < x_end)
+
+	{
+
+		const int tile_x = TileOrigin(x);
+
+		const int stop = std::min(x_end, tile_x + Constants::COORD_TILE);
+
+		const TileFrame f = MakeTileFrame(g, tile_x, y);
+
+		if (x == tile_x && stop == tile_x + Constants::COORD_TILE)
+
+		{
+
+			CoverageTile(g, f, cov);
+
+		}
+
+		else
+
+		{
+
+			CoverageTile(g, f, tile);
+
+			std::memcpy(cov, tile + (x - tile_x), static_cast<size_t>(stop - x) * sizeof(float));
+
+		}
+
+		cov += stop - x;
+
+		x = stop;
+
+	}
+
+}
+
+/**
+ * Coverage -> BlendFixed weights with ShadePixel()'s thresholds folded in:
+ * weight 0 and COVERAGE_ONE make BlendFixed return src / dst exactly, so
+ * the blend pass needs no branches.
+ */
+
+inline void WeightRun(const float *cov, std::uint32_t *weight, int n)
+
+{
+
+	const V::F one = V::Set1(static_cast<float>(Constants::COVERAGE_ONE));
+
+	const V::F full = V::Set1(Constants::COVERAGE_FULL);
+
+	const V::F eps = V::Set1(Constants::COVERAGE_EPSILON);
+
+	int i = 0;
+
+	for (; i + V::WIDTH <= n; i += V::WIDTH)
+
+	{
+
+		const V::F c = V::Load(cov + i);
+
+		V::F w = V::Add(V::Mul(c, one), V::Set1(0.5f));
+
+		w = V::Select(V::Ge(c, full), one, w);
+
+		V::StoreTrunc(reinterpret_cast<std::int32_t *>(weight + i), V::Select(V::Le(c, eps), V::Set1(0.0f), w));
+
+	}
+
+	for (; i < n; ++i)
+
+	{
+
+		const float c = cov[i];
+
+		weight[i] = c <= Constants::COVERAGE_EPSILON ? 0u : (c >= Constants::COVERAGE_FULL ? Constants::COVERAGE_ONE : QuantizeCoverage(c));
+
+	}
+
+}
+
+/**
+ * ShadeRun() body. The per-pixel loops are branch-free (selects only) and
+ * left to the compiler to vectorize for this instance's ISA.
+ */
+
+template<typename PixelType>
+
+inline void ShadeRun(const PixelType *in, PixelType *out, const PixelType &color, const float *cov, std::uint32_t *weight, int n)
+
+{
+
+	using Traits = PixelTraits<PixelType>;
+
+	using ChannelType = typename Traits::ChannelType;
+
+	if constexpr (std::is_floating_point<ChannelType>::value)
+
+	{
+
+		for (int i = 0; i < n; ++i)
+
+		{
+
+			const float c = cov[i];
+
+			const bool keep = c <= Constants::COVERAGE_EPSILON;
+
+			const bool fill = c >= Constants::COVERAGE_FULL;
+
+			const PixelType s = in[i];
+
+			const ChannelType r = Traits::Blend(s.red, color.red, c);
+
+			const ChannelType gr = Traits::Blend(s.green, color.green, c);
+
+			const ChannelType b = Traits::Blend(s.blue, color.blue, c);
+
+			out[i].red = fill ? color.red : (keep ? s.red : r);
+
+			out[i].green = fill ? color.green : (keep ? s.green : gr);
+
+			out[i].blue = fill ? color.blue : (keep ? s.blue : b);
+
+			out[i].alpha = s.alpha;
+
+		}
+
+	}
+
+	else if constexpr (!Traits::IsFloat)
+
+	{
+
+		WeightRun(cov, weight, n);
+
+		for (int i = 0; i < n; ++i)
+
+		{
+
+			const std::uint32_t w = weight[i];
+
+			const PixelType s = in[i];
+
+			out[i].red = BlendFixed(s.red, color.red, w);
+
+			out[i].green = BlendFixed(s.green, color.green, w);
+
+			out[i].blue = BlendFixed(s.blue, color.blue, w);
+
+			out[i].alpha = s.alpha;
+
+		}
+
+	}
+
+	else
+
+	{
+
+		// Packed float formats (half) bring their own ShadePixel overload
+		for (int i = 0; i < n; ++i)
+
+		{
+
+			ShadePixel(in[i], out[i], color, cov[i]);
+
+		}
+
+	}
+
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#ifndef SEP_COLOR_TELEMETRY_H
+#define SEP_COLOR_TELEMETRY_H
+
+// Opt-in render telemetry for the sep_color core.
+// Set SEP_COLOR_TELEMETRY to a file path before the host starts and every
+// render leaves one TelemetryRecord: wall time split into setup and the
+// copy / fill / band span kernels, pixel counts per span kind, bit depth,
+// mode, coverage and downsample. Records go into a fixed ring (the newest
+// TELEMETRY_CAPACITY survive) with one atomic increment per render and no
+// lock, and are appended to the file as JSON lines when the host shuts the
+// plugin down (AE: PF_Cmd_GLOBAL_SETDOWN).
+//
+// Off (the default), the ring is never allocated and a render pays a single
+// null test.
+
+#include "sep_color_Core.h"
+
+#include "sep_color_Platform.h"
+
+#include <atomic>
+
+#include <cinttypes>
+
+#include <cstdio>
+
+#include <string>
+
+namespace SepColor {
+
+struct TelemetryRecord
+{
+	std::uint64_t start_ns = 0;			// steady clock, for ordering and gaps
+	float setup_ms = 0.0f;				// geometry, color, band partition
+	float total_ms = 0.0f;				// wall time of the whole render
+	// Span kernel time summed over all workers (CPU ms, not wall)
+	float copy_ms = 0.0f;
+	float fill_ms = 0.0f;
+	float band_ms = 0.0f;
+	std::uint64_t copy_px = 0;
+	std::uint64_t fill_px = 0;
+	std::uint64_t blend_px = 0;			// band pixels
+	std::uint64_t transparent_px = 0;	// fill / band pixels with zero input alpha (0 in drafts)
+	int width = 0;
+	int height = 0;
+	int bitdepth = 8;
+	int mode = MODE_LINE;
+	int coverage = COVERAGE_LINEAR;
+	float downsample_x = 1.0f;
+	float downsample_y = 1.0f;
+	int status = 0;						// nonzero: cancelled or failed
+};
+
+class TelemetryRing
+{
+public:
+	static constexpr std::uint64_t TELEMETRY_CAPACITY = 4096;
+
+	explicit TelemetryRing(const std::string &path)
+		: path_(path)
+	{
+	}
+
+	TelemetryRing(const TelemetryRing &) = delete;
+	TelemetryRing &operator=(const TelemetryRing &) = delete;
+
+	// Safe from any number of renders at once
+	void Push(const TelemetryRecord &record)
+	{
+		const std::uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+
+		Slot &slot = slots_[index % TELEMETRY_CAPACITY];
+
+		slot.sequence.store(0, std::memory_order_relaxed);
+
+		slot.record = record;
+
+		slot.sequence.store(index + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Append the surviving records to the file, oldest first, and empty the
+	 * ring. Call with no render in flight. Returns false if the file could
+	 * not be written.
+	 */
+	bool Flush()
+	{
+		const std::uint64_t head = head_.load(std::memory_order_acquire);
+
+		const std::uint64_t first = head > TELEMETRY_CAPACITY ? head - TELEMETRY_CAPACITY : flushed_;
+
+		std::FILE *file = detail::OpenFile(path_, "a");
+
+		if (file == nullptr)
+
+		{
+
+			return false;
+
+		}
+
+		if (first > flushed_)
+
+		{
+
+			std::fprintf(file, "{\"dropped\":%" PRIu64 "}\n", first - flushed_);
+
+		}
+
+		for (std::uint64_t index = first; index < head; ++index)
+
+		{
+
+			const Slot &slot = slots_[index % TELEMETRY_CAPACITY];
+
+			if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+
+			{
+
+				continue;
+
+			}
+
+			const TelemetryRecord &r = slot.record;
+
+			std::fprintf(file,
+				"{\"frame\":%" PRIu64 ",\"start_ns\":%" PRIu64 ",\"width\":%d,\"height\":%d,\"bitdepth\":%d,"
+				"\"mode\":\"%s\",\"coverage\":%d,\"downsample\":[%g,%g],\"status\":%d,"
+				"\"setup_ms\":%.4f,\"copy_ms\":%.4f,\"fill_ms\":%.4f,\"band_ms\":%.4f,\"total_ms\":%.4f,"
+				"\"copy_px\":%" PRIu64 ",\"fill_px\":%" PRIu64 ",\"blend_px\":%" PRIu64 ",\"transparent_px\":%" PRIu64 "}\n",
+				index, r.start_ns, r.width, r.height, r.bitdepth,
+				r.mode == MODE_CIRCLE ? "circle" : "line", r.coverage, r.downsample_x, r.downsample_y, r.status,
+				r.setup_ms, r.copy_ms, r.fill_ms, r.band_ms, r.total_ms,
+				r.copy_px, r.fill_px, r.blend_px, r.transparent_px);
+
+		}
+
+		flushed_ = head;
+
+		return std::fclose(file) == 0;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<std::uint64_t> sequence{0};		// index + 1 once written
+		TelemetryRecord record;
+	};
+
+	std::string path_;
+	std::atomic<std::uint64_t> head_{0};
+	std::uint64_t flushed_ = 0;
+	Slot slots_[TELEMETRY_CAPACITY];
+};
+
+/**
+ * A ring for the file named by SEP_COLOR_TELEMETRY, or nullptr when the
+ * variable is unset or empty. The caller owns it.
+ */
+
+inline TelemetryRing *OpenTelemetryFromEnv()
+
+{
+
+	const std::string path = detail::GetEnv("SEP_COLOR_TELEMETRY");
+
+	return path.empty() ? nullptr : new TelemetryRing(path);
+
+}
+
+// Span timings and pixel counts of `record`, from a render's RenderStats
+
+inline void SetTelemetryStats(TelemetryRecord &record, const RenderStats &stats)
+
+{
+
+	const std::uint64_t *value = stats.value;
+
+	record.copy_ms = static_cast<float>(value[RenderStats::COPY_NS] * 1e-6);
+
+	record.fill_ms = static_cast<float>(value[RenderStats::FILL_NS] * 1e-6);
+
+	record.band_ms = static_cast<float>(value[RenderStats::BAND_NS] * 1e-6);
+
+	record.copy_px = value[RenderStats::COPY_PX];
+
+	record.fill_px = value[RenderStats::FILL_PX];
+
+	record.blend_px = value[RenderStats::BAND_PX];
+
+	record.transparent_px = value[RenderStats::TRANSPARENT_PX];
+
+}
+
+} // namespace SepColor
+
+#endif // SEP_COLOR_TELEMETRY_H
@@ -0,0 +1,267 @@
+#pragma once
+
+#ifndef SEP_COLOR_TRACE_H
+#define SEP_COLOR_TRACE_H
+
+// Compile-time trace zones for profiling the render pipeline.
+// Build with SEPCOLOR_TRACE=1 to record frame-level zones (host render,
+// geometry, band partition, per-thread workers and their bands), or 2 to
+// add the kernel phases of every row (classification, copy / fill / band
+// spans). With the default 0 every SEPCOLOR_ZONE expands to nothing.
+//
+// Each thread appends complete events to its own fixed buffer: no locks and
+// no shared cache lines on the hot path, two clock reads per zone.
+// WriteChromeTrace() dumps all buffers as Chrome trace-event JSON, which
+// Perfetto (ui.perfetto.dev) and chrome://tracing open directly. AE builds
+// write it at PF_Cmd_GLOBAL_SETDOWN to the file named by SEP_COLOR_TRACE.
+
+#ifndef SEPCOLOR_TRACE
+#define SEPCOLOR_TRACE 0
+#endif
+
+#if SEPCOLOR_TRACE
+
+#include "sep_color_Platform.h"
+
+#include <atomic>
+
+#include <chrono>
+
+#include <cstdint>
+
+#include <cstdio>
+
+#include <string>
+
+namespace SepColor {
+
+namespace trace {
+
+struct Event
+{
+	const char *name;		// string literal
+	std::uint64_t begin_ns;
+	std::uint64_t end_ns;
+};
+
+/**
+ * One thread's events. Only the owning thread writes; `count` is published
+ * with release order so a reader after the render sees whole events.
+ * Buffers live until the process exits (host threads may outlive a frame).
+ */
+
+struct ThreadBuffer
+{
+	static constexpr int CAPACITY = 1 << 18;
+
+	std::atomic<int> count{0};
+	std::atomic<int> dropped{0};			// events past CAPACITY
+	int tid = 0;
+	ThreadBuffer *next = nullptr;
+	Event events[CAPACITY];
+};
+
+inline std::atomic<ThreadBuffer *> g_buffers{nullptr};
+
+inline std::atomic<int> g_thread_count{0};
+
+inline std::uint64_t NowNs()
+
+{
+
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+}
+
+inline ThreadBuffer &LocalBuffer()
+
+{
+
+	// Trivial thread_local: no guard or TLS constructor involved
+	thread_local ThreadBuffer *buffer = nullptr;
+
+	if (buffer == nullptr)
+
+	{
+
+		buffer = new ThreadBuffer;
+
+		buffer->tid = g_thread_count.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		ThreadBuffer *head = g_buffers.load(std::memory_order_relaxed);
+
+		do
+
+		{
+
+			buffer->next = head;
+
+		} while (!g_buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+	}
+
+	return *buffer;
+
+}
+
+inline void Record(const char *name, std::uint64_t begin_ns, std::uint64_t end_ns)
+
+{
+
+	ThreadBuffer &buffer = LocalBuffer();
+
+	const int n = buffer.count.load(std::memory_order_relaxed);
+
+	if (n >= ThreadBuffer::CAPACITY)
+
+	{
+
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+
+		return;
+
+	}
+
+	buffer.events[n] = Event{ name, begin_ns, end_ns };
+
+	buffer.count.store(n + 1, std::memory_order_release);
+
+}
+
+class Zone
+{
+public:
+	explicit Zone(const char *name)
+		: name_(name), begin_ns_(NowNs())
+	{
+	}
+
+	~Zone()
+	{
+		Record(name_, begin_ns_, NowNs());
+	}
+
+	Zone(const Zone &) = delete;
+	Zone &operator=(const Zone &) = delete;
+
+private:
+	const char *name_;
+	std::uint64_t begin_ns_;
+};
+
+// Forget all recorded events. Call with no zone open on any thread.
+
+inline void ClearTrace()
+
+{
+
+	for (ThreadBuffer *b = g_buffers.load(std::memory_order_acquire); b != nullptr; b = b->next)
+
+	{
+
+		b->count.store(0, std::memory_order_relaxed);
+
+		b->dropped.store(0, std::memory_order_relaxed);
+
+	}
+
+}
+
+/**
+ * Write every thread's events to `path` as Chrome trace-event JSON and
+ * clear them. Call with no zone open on any thread. Returns false if the
+ * file could not be written.
+ */
+
+inline bool WriteChromeTrace(const std::string &path)
+
+{
+
+	std::FILE *file = detail::OpenFile(path, "w");
+
+	if (file == nullptr)
+
+	{
+
+		return false;
+
+	}
+
+	// Timestamps are microseconds from the earliest event
+	std::uint64_t origin = UINT64_MAX;
+
+	for (ThreadBuffer *b = g_buffers.load(std::memory_order_acquire); b != nullptr; b = b->next)
+
+	{
+
+		const int n = b->count.load(std::memory_order_acquire);
+
+		for (int i = 0; i < n; ++i)
+
+		{
+
+			origin = b->events[i].begin_ns < origin ? b->events[i].begin_ns : origin;
+
+		}
+
+	}
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"sep_color\"}}");
+
+	for (ThreadBuffer *b = g_buffers.load(std::memory_order_acquire); b != nullptr; b = b->next)
+
+	{
+
+		const int n = b->count.load(std::memory_order_acquire);
+
+		std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"sep_color %d\",\"dropped\":%d}}",
+			b->tid, b->tid, b->dropped.load(std::memory_order_relaxed));
+
+		for (int i = 0; i < n; ++i)
+
+		{
+
+			const Event &e = b->events[i];
+
+			std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"sep_color\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				e.name, b->tid, static_cast<double>(e.begin_ns - origin) * 1e-3, static_cast<double>(e.end_ns - e.begin_ns) * 1e-3);
+
+		}
+
+	}
+
+	std::fprintf(file, "\n]}\n");
+
+	ClearTrace();
+
+	return std::fclose(file) == 0;
+
+}
+
+} // namespace trace
+
+} // namespace SepColor
+
+#define SEPCOLOR_TRACE_CONCAT2(a, b) a##b
+#define SEPCOLOR_TRACE_CONCAT(a, b) SEPCOLOR_TRACE_CONCAT2(a, b)
+
+// Scoped zone until the end of the enclosing block; `name` must outlive the
+// trace (a string literal)
+#define SEPCOLOR_ZONE(name) const ::SepColor::trace::Zone SEPCOLOR_TRACE_CONCAT(sepcolor_zone_, __LINE__)(name)
+
+#else
+
+#define SEPCOLOR_ZONE(name) ((void)0)
+
+#endif // SEPCOLOR_TRACE
+
+// Per-row kernel zones, SEPCOLOR_TRACE=2 only
+#if SEPCOLOR_TRACE >= 2
+#define SEPCOLOR_ZONE_DETAIL(name) SEPCOLOR_ZONE(name)
+#else
+#define SEPCOLOR_ZONE_DETAIL(name) ((void)0)
+#endif
+
+#endif // SEP_COLOR_TRACE_H
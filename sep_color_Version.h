@@ -0,0 +1,17 @@
+#pragma once
+
+#ifndef SEP_COLOR_VERSION_H
+#define SEP_COLOR_VERSION_H
+
+// Plugin version, shared by the AE build (sep_color.h, PiPL) and the OFX
+// build (sep_color_OFX.cpp). Preprocessor only and no SDK includes, so Rez
+// and the Linux build can both read it. STAGE_VERSION names an AE SDK
+// constant and is only expanded where that SDK is included.
+
+#define MAJOR_VERSION 1
+#define MINOR_VERSION 1
+#define BUG_VERSION 0
+#define STAGE_VERSION PF_Stage_DEVELOP
+#define BUILD_VERSION 1
+
+#endif // SEP_COLOR_VERSION_H
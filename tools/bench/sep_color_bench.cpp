@@ -0,0 +1,1319 @@
+// Render benchmarks for the sep_color core.
+// Runs the same kernels and scheduler as the plugins on a
+// small persistent thread pool (the stand-in for AE's iterate_generic or
+// the OFX MultiThread suite), for every mode x bit depth x frame size, and
+// prints the median frame time and throughput of each case. Further cases
+// time variants of the UHD frames: -area with exact pixel-area coverage,
+// -perpixel through a per-pixel callback (Coverage() and ShadePixel() per
+// pixel, as before the row pipeline), and planar-* from one plane per
+// channel (sep_color_Planar.h); ycbcr420-* renders a 4:2:0 frame natively
+// or via the RGBA round trip a host would otherwise do, and circle-edge-*
+// a small circle near the right edge through RenderJob's cost-balanced
+// bands or one equal row block per thread. No host SDK is needed; see
+// Makefile.
+//
+// --scaling times each case at 1, 2, 4 ... --threads threads instead and
+// prints the speedup over one thread (make scaling: the circle-edge cases,
+// which show the partitioner's scaling on a many-core machine).
+//
+// --json writes the results for use as a baseline; --baseline compares a
+// run against one and exits with 1 when any case's median throughput falls
+// more than --threshold percent below it (make check, against the committed
+// baseline.json, a local fallback only; see README.md). Frame times are
+// noisy on shared machines (+-20 % on a busy one-core runner), so the
+// default threshold is the CI gate's 15 %, and a case that looks regressed
+// is run again up to --retries times and keeps its best median before it
+// counts. A --json run without --baseline records the median of
+// 1 + --retries runs per case.
+//
+// Trace builds (make trace, SEPCOLOR_TRACE=2) also write one Chrome trace
+// per case to --trace-dir, for Perfetto / chrome://tracing.
+//
+//   sep_color_bench [--reps N] [--threads N] [--coverage N] [--filter TEXT]
+//                   [--json FILE] [--baseline FILE] [--threshold PCT]
+//                   [--retries N] [--trace-dir DIR] [--scaling]
+
+#include "sep_color_bench.h"
+
+#include "sep_color_Autotune.h"		// detail::CpuModel
+
+#include "sep_color_Platform.h"		// detail::OpenFile
+
+#include "sep_color_Planar.h"
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <chrono>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <filesystem>
+
+#include <fstream>
+
+#include <string>
+
+#include <vector>
+
+using namespace SepColor;
+
+// -------------------------------------------------------------
+
+// Cases
+
+// -------------------------------------------------------------
+
+struct BenchSize
+{
+	const char *name;
+	int width;
+	int height;
+};
+
+static const BenchSize BENCH_SIZES[] = {
+	{ "HD", 1920, 1080 },
+	{ "UHD", 3840, 2160 },
+	{ "8K", 7680, 4320 }
+};
+
+struct BenchOptions
+{
+	int reps = 9;
+	int threads = 0;								// 0: all hardware threads
+	int coverage = COVERAGE_LINEAR;					// the Antialiasing default
+	std::string filter;
+	std::string json_path;
+	std::string baseline_path;
+	double threshold = 15.0;						// percent of baseline throughput
+	int retries = 3;
+	std::string trace_dir = "traces";
+	bool scaling = false;							// time each case at 1, 2, 4 ... threads
+};
+
+// What a case renders. RGBA is the plugins' path (RenderJob + RunRenderWorker);
+// the others are the core's planar entry points, split into bands the same way.
+enum BenchKernel
+{
+	KERNEL_RGBA = 0,
+	KERNEL_EQUAL_ROWS,		// the RGBA frame split into one equal row block per thread
+	KERNEL_PER_PIXEL,		// the RGBA frame through a per-pixel callback: Coverage() + ShadePixel()
+	KERNEL_PLANAR,			// RenderPlanarRows on separate R, G, B, A planes
+	KERNEL_YCBCR,			// RenderYCbCrRows on 4:2:0 planes
+	KERNEL_YCBCR_RGBA		// the same frame via 4:2:0 -> RGBA, RenderRows, RGBA -> 4:2:0
+};
+
+struct BenchCase
+{
+	std::string name;								// e.g. "circle-16-UHD"
+	int mode;
+	int depth;
+	const BenchSize *size;
+	BenchKernel kernel = KERNEL_RGBA;
+	bool exact_area = false;						// COVERAGE_AREA instead of --coverage
+	bool edge_circle = false;						// a small circle near the right edge
+};
+
+struct BenchResult
+{
+	double median_ms = 0.0;
+	double mpix_per_s = 0.0;
+};
+
+struct BenchBaseline
+{
+	std::string cpu;
+	int threads = 0;
+	int isa = -1;
+	int coverage = -1;
+	std::vector<std::pair<std::string, double>> mpix_per_s;		// by case name
+};
+
+static const char *const MODE_NAMES[] = { "", "line", "circle" };
+
+// The boundary crosses the frame centre: a line at 30 degrees, or a circle
+// of radius 0.35 * height. The edge circle (radius 0.07 * height, centred
+// near the right edge) puts the whole band in a few rows: the worst case
+// for splitting frames into equal row counts.
+static Geometry BenchGeometry(const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	const int w = bench_case.size->width;
+
+	const int h = bench_case.size->height;
+
+	const int coverage = bench_case.exact_area ? static_cast<int>(COVERAGE_AREA) : options.coverage;
+
+	if (bench_case.edge_circle)
+
+	{
+
+		return MakeGeometry(MODE_CIRCLE, w * 0.985, h * 0.88, 0.0f, h * 0.07f, 1.0f, 1.0f, coverage, 4.0f);
+
+	}
+
+	return MakeGeometry(bench_case.mode, w * 0.5, h * 0.5, 30.0f * Constants::DEG_TO_RAD, h * 0.35f, 1.0f, 1.0f, coverage, 4.0f);
+
+}
+
+// Time frame() over --reps frames (plus one warm-up) and report the median.
+// Short frames keep going until MIN_SAMPLE_MS of timed frames (at most
+// MAX_FRAMES): nine 1 ms HD frames swing by +-15 % on a shared machine,
+// a couple of hundred of them do not.
+constexpr double MIN_SAMPLE_MS = 250.0;
+
+constexpr int MAX_FRAMES = 250;
+
+template<typename Frame>
+
+static BenchResult TimeFrames(const BenchOptions &options, const BenchCase &bench_case, Frame &&frame)
+
+{
+
+#if SEPCOLOR_TRACE
+	trace::ClearTrace();
+#endif
+
+	std::vector<double> times;
+
+	double total_ms = 0.0;
+
+	for (int rep = 0; rep <= options.reps || (total_ms < MIN_SAMPLE_MS && rep <= MAX_FRAMES); ++rep)
+
+	{
+
+		SEPCOLOR_ZONE("Frame");
+
+		const auto start = std::chrono::steady_clock::now();
+
+		frame();
+
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (rep > 0)	// rep 0 warms caches and page mappings
+
+		{
+
+			times.push_back(ms);
+
+			total_ms += ms;
+
+		}
+
+	}
+
+#if SEPCOLOR_TRACE
+	std::filesystem::create_directories(options.trace_dir);
+
+	trace::WriteChromeTrace(options.trace_dir + "/" + bench_case.name + ".json");
+#endif
+
+	std::sort(times.begin(), times.end());
+
+	BenchResult result;
+
+	result.median_ms = times[times.size() / 2];
+
+	result.mpix_per_s = static_cast<double>(bench_case.size->width) * bench_case.size->height / (result.median_ms * 1e3);
+
+	return result;
+
+}
+
+// Rows [0, rows) in bands taken from a shared counter by every pool thread
+template<typename Body>
+
+static void RunBands(BenchPool &pool, int rows, int band, Body &&body)
+
+{
+
+	std::atomic<int> next(0);
+
+	pool.Run([&] {
+
+		for (int y0 = next.fetch_add(band); y0 < rows; y0 = next.fetch_add(band))
+
+		{
+
+			body(y0, std::min(rows, y0 + band));
+
+		}
+
+	});
+
+}
+
+template<typename PixelType>
+
+static BenchResult RunRgbaCase(BenchPool &pool, const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	const int w = bench_case.size->width;
+
+	const int h = bench_case.size->height;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h);
+
+	std::vector<PixelType> dst(src.size());
+
+	FillSource(src, w, h);
+
+	PixelType color;
+
+	color.alpha = static_cast<typename PixelTraits<PixelType>::ChannelType>(PixelTraits<PixelType>::MAX_CHANNEL);
+
+	color.red = color.alpha;
+
+	color.green = 0;
+
+	color.blue = 0;
+
+	const ImageView<const PixelType> src_view(src.data(), w, h, static_cast<std::ptrdiff_t>(w * sizeof(PixelType)));
+
+	const ImageView<PixelType> dst_view(dst.data(), w, h, static_cast<std::ptrdiff_t>(w * sizeof(PixelType)));
+
+	if (bench_case.kernel == KERNEL_EQUAL_ROWS)
+
+	{
+
+		return TimeFrames(options, bench_case, [&] {
+
+			const Geometry geom = BenchGeometry(options, bench_case);
+
+			const int parts = pool.Threads();
+
+			std::atomic<int> next(0);
+
+			pool.Run([&] {
+
+				const int i = next.fetch_add(1);
+
+				RenderRows(src_view, dst_view, geom, color, h * i / parts, h * (i + 1) / parts);
+
+			});
+
+		});
+
+	}
+
+	return TimeFrames(options, bench_case, [&] {
+
+		// Per frame, as in the plugins: geometry, band partition, parallel call
+		const Geometry geom = BenchGeometry(options, bench_case);
+
+		RenderJob<PixelType> job(src_view, dst_view, geom, color);
+
+		pool.Run([&job] { RunRenderWorker(job); });
+
+	});
+
+}
+
+// The callback shape of AE's iterate suites, as the plugin used before the
+// row pipeline: one indirect call per pixel, coverage evaluated per pixel
+template<typename PixelType>
+
+struct PerPixelRefcon
+{
+	Geometry geom;
+	PixelType color;
+};
+
+template<typename PixelType>
+
+static int ShadeOnePixel(void *refcon, int x, int y, const PixelType *in, PixelType *out)
+
+{
+
+	const PerPixelRefcon<PixelType> *r = static_cast<const PerPixelRefcon<PixelType> *>(refcon);
+
+	ShadePixel(*in, *out, r->color, Coverage(r->geom, x, y));
+
+	return 0;
+
+}
+
+template<typename PixelType>
+
+static BenchResult RunPerPixelCase(BenchPool &pool, const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	const int w = bench_case.size->width;
+
+	const int h = bench_case.size->height;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h);
+
+	std::vector<PixelType> dst(src.size());
+
+	FillSource(src, w, h);
+
+	PerPixelRefcon<PixelType> refcon;
+
+	refcon.color.alpha = static_cast<typename PixelTraits<PixelType>::ChannelType>(PixelTraits<PixelType>::MAX_CHANNEL);
+
+	refcon.color.red = refcon.color.alpha;
+
+	refcon.color.green = 0;
+
+	refcon.color.blue = 0;
+
+	// Read through a volatile, as the host's call would be: never inlined
+	int (*volatile callback)(void *, int, int, const PixelType *, PixelType *) = ShadeOnePixel<PixelType>;
+
+	return TimeFrames(options, bench_case, [&] {
+
+		refcon.geom = BenchGeometry(options, bench_case);
+
+		RunBands(pool, h, 32, [&](int y0, int y1) {
+
+			for (int y = y0; y < y1; ++y)
+
+			{
+
+				int (*const shade)(void *, int, int, const PixelType *, PixelType *) = callback;
+
+				const PixelType *in = src.data() + static_cast<std::size_t>(y) * w;
+
+				PixelType *out = dst.data() + static_cast<std::size_t>(y) * w;
+
+				for (int x = 0; x < w; ++x)
+
+				{
+
+					shade(&refcon, x, y, in + x, out + x);
+
+				}
+
+			}
+
+		});
+
+	});
+
+}
+
+// The RGBA case's frame as one plane per channel (alpha shared, untouched)
+template<typename SampleType>
+
+static BenchResult RunPlanarCase(BenchPool &pool, const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	using PixelType = typename std::conditional<sizeof(SampleType) == 1, BenchPixel8, typename std::conditional<sizeof(SampleType) == 2, BenchPixel16, BenchPixel32>::type>::type;
+
+	const int w = bench_case.size->width;
+
+	const int h = bench_case.size->height;
+
+	std::vector<PixelType> pixels(static_cast<std::size_t>(w) * h);
+
+	FillSource(pixels, w, h);
+
+	std::vector<SampleType> planes[7];
+
+	for (std::vector<SampleType> &plane : planes)
+
+	{
+
+		plane.resize(pixels.size());
+
+	}
+
+	for (std::size_t i = 0; i < pixels.size(); ++i)
+
+	{
+
+		planes[0][i] = pixels[i].red;
+
+		planes[1][i] = pixels[i].green;
+
+		planes[2][i] = pixels[i].blue;
+
+		planes[3][i] = pixels[i].alpha;
+
+	}
+
+	const std::ptrdiff_t rowbytes = w * sizeof(SampleType);
+
+	PlanarView<SampleType> src, dst;
+
+	src.red = ImageView<SampleType>(planes[0].data(), w, h, rowbytes);
+
+	src.green = ImageView<SampleType>(planes[1].data(), w, h, rowbytes);
+
+	src.blue = ImageView<SampleType>(planes[2].data(), w, h, rowbytes);
+
+	src.alpha = ImageView<SampleType>(planes[3].data(), w, h, rowbytes);
+
+	dst = src;
+
+	dst.red.data = planes[4].data();
+
+	dst.green.data = planes[5].data();
+
+	dst.blue.data = planes[6].data();
+
+	PlanarColor color;
+
+	color.red = PixelTraits<PixelType>::MAX_CHANNEL;
+
+	const PlanarView<const SampleType> src_view = src;
+
+	return TimeFrames(options, bench_case, [&] {
+
+		const Geometry geom = BenchGeometry(options, bench_case);
+
+		RunBands(pool, h, 32, [&](int y0, int y1) { RenderPlanarRows(src_view, dst, geom, color, y0, y1); });
+
+	});
+
+}
+
+// BT.709 video-range 4:2:0 <-> 8-bit RGBA for rows [y0, y1) (y0, y1 even),
+// the conversion a host without native Y'CbCr support does around the effect
+static void YCbCrToRgba(const YCbCrView<const std::uint8_t> &yuv, const ImageView<BenchPixel8> &rgba, int y0, int y1)
+
+{
+
+	for (int y = y0; y < y1; ++y)
+
+	{
+
+		const std::uint8_t *luma = yuv.y.Row(y);
+
+		const std::uint8_t *cb = yuv.cb.Row(y >> 1);
+
+		const std::uint8_t *cr = yuv.cr.Row(y >> 1);
+
+		BenchPixel8 *out = rgba.Row(y);
+
+		for (int x = 0; x < rgba.width; ++x)
+
+		{
+
+			const float l = (luma[x] - 16.0f) / 219.0f;
+
+			const float pb = (cb[x >> 1] - 128.0f) / 224.0f;
+
+			const float pr = (cr[x >> 1] - 128.0f) / 224.0f;
+
+			const float r = l + 1.5748f * pr;
+
+			const float b = l + 1.8556f * pb;
+
+			const float g = (l - 0.2126f * r - 0.0722f * b) / 0.7152f;
+
+			out[x].alpha = 255;
+
+			out[x].red = static_cast<std::uint8_t>(std::max(0.0f, std::min(255.0f, r * 255.0f + 0.5f)));
+
+			out[x].green = static_cast<std::uint8_t>(std::max(0.0f, std::min(255.0f, g * 255.0f + 0.5f)));
+
+			out[x].blue = static_cast<std::uint8_t>(std::max(0.0f, std::min(255.0f, b * 255.0f + 0.5f)));
+
+		}
+
+	}
+
+}
+
+static void RgbaToYCbCr(const ImageView<const BenchPixel8> &rgba, const YCbCrView<std::uint8_t> &yuv, int y0, int y1)
+
+{
+
+	for (int y = y0; y < y1; y += 2)
+
+	{
+
+		for (int x = 0; x < rgba.width; x += 2)
+
+		{
+
+			float sum_pb = 0.0f, sum_pr = 0.0f;
+
+			for (int k = 0; k < 4; ++k)
+
+			{
+
+				const BenchPixel8 &p = rgba.Row(y + (k >> 1))[x + (k & 1)];
+
+				const float r = p.red / 255.0f, g = p.green / 255.0f, b = p.blue / 255.0f;
+
+				const float l = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+
+				yuv.y.Row(y + (k >> 1))[x + (k & 1)] = static_cast<std::uint8_t>(16.0f + 219.0f * l + 0.5f);
+
+				sum_pb += (b - l) / 1.8556f;
+
+				sum_pr += (r - l) / 1.5748f;
+
+			}
+
+			yuv.cb.Row(y >> 1)[x >> 1] = static_cast<std::uint8_t>(128.0f + 56.0f * sum_pb + 0.5f);
+
+			yuv.cr.Row(y >> 1)[x >> 1] = static_cast<std::uint8_t>(128.0f + 56.0f * sum_pr + 0.5f);
+
+		}
+
+	}
+
+}
+
+// 8-bit 4:2:0 BT.709 frame rendered natively, or converted to RGBA and back
+static BenchResult RunYCbCrCase(BenchPool &pool, const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	const int w = bench_case.size->width;
+
+	const int h = bench_case.size->height;
+
+	std::vector<std::uint8_t> planes[6];
+
+	for (int i = 0; i < 6; ++i)
+
+	{
+
+		planes[i].resize(i % 3 == 0 ? static_cast<std::size_t>(w) * h : static_cast<std::size_t>(w / 2) * (h / 2));
+
+	}
+
+	for (int y = 0; y < h; ++y)
+
+	{
+
+		for (int x = 0; x < w; ++x)
+
+		{
+
+			planes[0][static_cast<std::size_t>(y) * w + x] = static_cast<std::uint8_t>(16 + 219 * x / w);
+
+			if ((x | y) % 2 == 0)
+
+			{
+
+				planes[1][static_cast<std::size_t>(y / 2) * (w / 2) + x / 2] = static_cast<std::uint8_t>(16 + 224 * y / h);
+
+				planes[2][static_cast<std::size_t>(y / 2) * (w / 2) + x / 2] = 128;
+
+			}
+
+		}
+
+	}
+
+	YCbCrFormat format;
+
+	format.subsampling = CHROMA_420;
+
+	format.matrix = MATRIX_BT709;
+
+	YCbCrView<std::uint8_t> views[2];
+
+	for (int i = 0; i < 2; ++i)
+
+	{
+
+		views[i].y = ImageView<std::uint8_t>(planes[i * 3].data(), w, h, w);
+
+		views[i].cb = ImageView<std::uint8_t>(planes[i * 3 + 1].data(), w / 2, h / 2, w / 2);
+
+		views[i].cr = ImageView<std::uint8_t>(planes[i * 3 + 2].data(), w / 2, h / 2, w / 2);
+
+		views[i].format = format;
+
+	}
+
+	const YCbCrView<const std::uint8_t> src = views[0];
+
+	const YCbCrView<std::uint8_t> dst = views[1];
+
+	if (bench_case.kernel == KERNEL_YCBCR)
+
+	{
+
+		const YCbCrColor color = ColorToYCbCr(1.0f, 0.0f, 0.0f, format);
+
+		return TimeFrames(options, bench_case, [&] {
+
+			const Geometry geom = BenchGeometry(options, bench_case);
+
+			RunBands(pool, src.ChromaHeight(), 16, [&](int cy0, int cy1) { RenderYCbCrRows(src, dst, geom, color, cy0, cy1); });
+
+		});
+
+	}
+
+	std::vector<BenchPixel8> rgba(static_cast<std::size_t>(w) * h), shaded(rgba.size());
+
+	const ImageView<BenchPixel8> rgba_view(rgba.data(), w, h, w * sizeof(BenchPixel8));
+
+	const ImageView<BenchPixel8> shaded_view(shaded.data(), w, h, w * sizeof(BenchPixel8));
+
+	const BenchPixel8 color = { 255, 255, 0, 0 };
+
+	return TimeFrames(options, bench_case, [&] {
+
+		const Geometry geom = BenchGeometry(options, bench_case);
+
+		RunBands(pool, h, 32, [&](int y0, int y1) {
+
+			YCbCrToRgba(src, rgba_view, y0, y1);
+
+			RenderRows(ImageView<const BenchPixel8>(rgba_view), shaded_view, geom, color, y0, y1);
+
+			RgbaToYCbCr(shaded_view, dst, y0, y1);
+
+		});
+
+	});
+
+}
+
+static BenchResult RunCase(BenchPool &pool, const BenchOptions &options, const BenchCase &bench_case)
+
+{
+
+	if (bench_case.kernel == KERNEL_YCBCR || bench_case.kernel == KERNEL_YCBCR_RGBA)
+
+	{
+
+		return RunYCbCrCase(pool, options, bench_case);
+
+	}
+
+	switch (bench_case.kernel)
+
+	{
+
+	case KERNEL_PER_PIXEL:
+
+		return bench_case.depth == 8 ? RunPerPixelCase<BenchPixel8>(pool, options, bench_case) :
+			bench_case.depth == 16 ? RunPerPixelCase<BenchPixel16>(pool, options, bench_case) : RunPerPixelCase<BenchPixel32>(pool, options, bench_case);
+
+	case KERNEL_PLANAR:
+
+		return bench_case.depth == 8 ? RunPlanarCase<std::uint8_t>(pool, options, bench_case) :
+			bench_case.depth == 16 ? RunPlanarCase<std::uint16_t>(pool, options, bench_case) : RunPlanarCase<float>(pool, options, bench_case);
+
+	default:
+
+		return bench_case.depth == 8 ? RunRgbaCase<BenchPixel8>(pool, options, bench_case) :
+			bench_case.depth == 16 ? RunRgbaCase<BenchPixel16>(pool, options, bench_case) : RunRgbaCase<BenchPixel32>(pool, options, bench_case);
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Baseline files
+
+// -------------------------------------------------------------
+
+// Only reads what WriteJson() writes: one case per line, fixed key order
+
+static std::string JsonString(const std::string &text, const std::string &key, std::size_t from = 0)
+
+{
+
+	const std::string tag = "\"" + key + "\":\"";
+
+	const std::size_t begin = text.find(tag, from);
+
+	if (begin == std::string::npos)
+
+	{
+
+		return std::string();
+
+	}
+
+	const std::size_t first = begin + tag.size();
+
+	return text.substr(first, text.find('"', first) - first);
+
+}
+
+static double JsonNumber(const std::string &text, const std::string &key, double fallback)
+
+{
+
+	const std::string tag = "\"" + key + "\":";
+
+	const std::size_t begin = text.find(tag);
+
+	return begin == std::string::npos ? fallback : std::strtod(text.c_str() + begin + tag.size(), nullptr);
+
+}
+
+static bool ReadBaseline(const std::string &path, BenchBaseline &baseline)
+
+{
+
+	std::ifstream file(path);
+
+	if (!file)
+
+	{
+
+		return false;
+
+	}
+
+	std::string line;
+
+	while (std::getline(file, line))
+
+	{
+
+		const std::string name = JsonString(line, "name");
+
+		if (!name.empty())
+
+		{
+
+			baseline.mpix_per_s.emplace_back(name, JsonNumber(line, "mpix_per_s", 0.0));
+
+			continue;
+
+		}
+
+		if (line.find("\"cpu\"") != std::string::npos)
+
+		{
+
+			baseline.cpu = JsonString(line, "cpu");
+
+			baseline.threads = static_cast<int>(JsonNumber(line, "threads", 0.0));
+
+			baseline.isa = static_cast<int>(JsonNumber(line, "isa", -1.0));
+
+			baseline.coverage = static_cast<int>(JsonNumber(line, "coverage", -1.0));
+
+		}
+
+	}
+
+	return !baseline.mpix_per_s.empty();
+
+}
+
+static const double *FindBaseline(const BenchBaseline &baseline, const std::string &name)
+
+{
+
+	for (const auto &entry : baseline.mpix_per_s)
+
+	{
+
+		if (entry.first == name)
+
+		{
+
+			return &entry.second;
+
+		}
+
+	}
+
+	return nullptr;
+
+}
+
+static bool WriteJson(const std::string &path, const BenchOptions &options, int threads, const std::string &cpu,
+	const std::vector<BenchCase> &cases, const std::vector<BenchResult> &results)
+
+{
+
+	std::FILE *file = detail::OpenFile(path, "w");
+
+	if (file == nullptr)
+
+	{
+
+		return false;
+
+	}
+
+	std::string safe_cpu = cpu;
+
+	for (char &c : safe_cpu)
+
+	{
+
+		c = (c == '"' || c == '\\') ? ' ' : c;
+
+	}
+
+	std::fprintf(file, "{\n\"cpu\":\"%s\",\"threads\":%d,\"isa\":%d,\"coverage\":%d,\"reps\":%d,\n\"cases\":[\n",
+		safe_cpu.c_str(), threads, static_cast<int>(ActiveSimdIsa()), options.coverage, options.reps);
+
+	for (std::size_t i = 0; i < cases.size(); ++i)
+
+	{
+
+		const BenchCase &c = cases[i];
+
+		std::fprintf(file, "{\"name\":\"%s\",\"mode\":\"%s\",\"depth\":%d,\"size\":\"%s\",\"width\":%d,\"height\":%d,\"median_ms\":%.3f,\"mpix_per_s\":%.1f}%s\n",
+			c.name.c_str(), MODE_NAMES[c.mode], c.depth, c.size->name, c.size->width, c.size->height,
+			results[i].median_ms, results[i].mpix_per_s, i + 1 < cases.size() ? "," : "");
+
+	}
+
+	std::fprintf(file, "]\n}\n");
+
+	return std::fclose(file) == 0;
+
+}
+
+static bool ParseArgs(int argc, char **argv, BenchOptions &options)
+
+{
+
+	for (int i = 1; i < argc; ++i)
+
+	{
+
+		const std::string arg = argv[i];
+
+		const bool has_value = i + 1 < argc;
+
+		if (arg == "--reps" && has_value)
+
+		{
+
+			options.reps = std::max(1, std::atoi(argv[++i]));
+
+		}
+
+		else if (arg == "--threads" && has_value)
+
+		{
+
+			options.threads = std::max(0, std::atoi(argv[++i]));
+
+		}
+
+		else if (arg == "--coverage" && has_value)
+
+		{
+
+			options.coverage = std::max(0, std::min(static_cast<int>(COVERAGE_SMOOTHSTEP), std::atoi(argv[++i])));
+
+		}
+
+		else if (arg == "--filter" && has_value)
+
+		{
+
+			options.filter = argv[++i];
+
+		}
+
+		else if (arg == "--json" && has_value)
+
+		{
+
+			options.json_path = argv[++i];
+
+		}
+
+		else if (arg == "--baseline" && has_value)
+
+		{
+
+			options.baseline_path = argv[++i];
+
+		}
+
+		else if (arg == "--threshold" && has_value)
+
+		{
+
+			options.threshold = std::max(0.0, std::atof(argv[++i]));
+
+		}
+
+		else if (arg == "--retries" && has_value)
+
+		{
+
+			options.retries = std::max(0, std::atoi(argv[++i]));
+
+		}
+
+		else if (arg == "--trace-dir" && has_value)
+
+		{
+
+			options.trace_dir = argv[++i];
+
+		}
+
+		else if (arg == "--scaling")
+
+		{
+
+			options.scaling = true;
+
+		}
+
+		else
+
+		{
+
+			std::fprintf(stderr, "usage: %s [--reps N] [--threads N] [--coverage N] [--filter TEXT]\n"
+				"       [--json FILE] [--baseline FILE] [--threshold PCT] [--retries N] [--trace-dir DIR] [--scaling]\n", argv[0]);
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+int main(int argc, char **argv)
+
+{
+
+	BenchOptions options;
+
+	if (!ParseArgs(argc, argv, options))
+
+	{
+
+		return 2;
+
+	}
+
+	BenchBaseline baseline;
+
+	const bool compare = !options.baseline_path.empty();
+
+	if (compare && !ReadBaseline(options.baseline_path, baseline))
+
+	{
+
+		std::fprintf(stderr, "cannot read baseline %s\n", options.baseline_path.c_str());
+
+		return 2;
+
+	}
+
+	const int threads = options.threads > 0 ? options.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	const std::string cpu = detail::CpuModel();
+
+	SetSimdIsa(DetectSimdIsa());
+
+	BenchPool pool(threads);
+
+	std::printf("# sep_color bench: %s, %d threads, ISA %d, coverage %d, %d reps\n", cpu.c_str(), threads, static_cast<int>(ActiveSimdIsa()), options.coverage, options.reps);
+
+	if (compare)
+
+	{
+
+		std::printf("# baseline %s: %s, %d threads, ISA %d, coverage %d; threshold -%.1f%%\n", options.baseline_path.c_str(),
+			baseline.cpu.c_str(), baseline.threads, baseline.isa, baseline.coverage, options.threshold);
+
+		if (baseline.cpu != cpu || baseline.threads != threads || baseline.isa != static_cast<int>(ActiveSimdIsa()) || baseline.coverage != options.coverage)
+
+		{
+
+			std::printf("# warning: the baseline was measured on a different setup; regenerate it here (make baseline) for a meaningful gate\n");
+
+		}
+
+	}
+
+	std::vector<BenchCase> cases;
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int depth : { 8, 16, 32 })
+
+		{
+
+			for (const BenchSize &size : BENCH_SIZES)
+
+			{
+
+				const std::string name = std::string(MODE_NAMES[mode]) + "-" + std::to_string(depth) + "-" + size.name;
+
+				if (options.filter.empty() || name.find(options.filter) != std::string::npos)
+
+				{
+
+					cases.push_back(BenchCase{ name, mode, depth, &size });
+
+				}
+
+			}
+
+		}
+
+	}
+
+	// At UHD, against the cases above: exact pixel-area coverage, and the
+	// per-pixel callback the row pipeline replaced
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int depth : { 8, 16, 32 })
+
+		{
+
+			const std::string name = std::string(MODE_NAMES[mode]) + "-" + std::to_string(depth) + "-UHD";
+
+			if (options.filter.empty() || (name + "-area").find(options.filter) != std::string::npos)
+
+			{
+
+				cases.push_back(BenchCase{ name + "-area", mode, depth, &BENCH_SIZES[1], KERNEL_RGBA, true });
+
+			}
+
+			if (options.filter.empty() || (name + "-perpixel").find(options.filter) != std::string::npos)
+
+			{
+
+				cases.push_back(BenchCase{ name + "-perpixel", mode, depth, &BENCH_SIZES[1], KERNEL_PER_PIXEL });
+
+			}
+
+		}
+
+	}
+
+	// Small circle near the edge, cost-balanced bands against equal row blocks
+	for (BenchKernel kernel : { KERNEL_RGBA, KERNEL_EQUAL_ROWS })
+
+	{
+
+		const std::string name = std::string("circle-edge-8-UHD") + (kernel == KERNEL_EQUAL_ROWS ? "-equalrows" : "");
+
+		if (options.filter.empty() || name.find(options.filter) != std::string::npos)
+
+		{
+
+			cases.push_back(BenchCase{ name, MODE_CIRCLE, 8, &BENCH_SIZES[1], kernel, false, true });
+
+		}
+
+	}
+
+	// Planar RGB at UHD, against the interleaved cases above
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int depth : { 8, 16, 32 })
+
+		{
+
+			const std::string name = std::string("planar-") + MODE_NAMES[mode] + "-" + std::to_string(depth) + "-UHD";
+
+			if (options.filter.empty() || name.find(options.filter) != std::string::npos)
+
+			{
+
+				cases.push_back(BenchCase{ name, mode, depth, &BENCH_SIZES[1], KERNEL_PLANAR });
+
+			}
+
+		}
+
+	}
+
+	// Native Y'CbCr against the RGBA round trip a host would otherwise do
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (BenchKernel kernel : { KERNEL_YCBCR, KERNEL_YCBCR_RGBA })
+
+		{
+
+			const std::string name = std::string("ycbcr420-") + MODE_NAMES[mode] + "-8-UHD" + (kernel == KERNEL_YCBCR_RGBA ? "-rgba" : "");
+
+			if (options.filter.empty() || name.find(options.filter) != std::string::npos)
+
+			{
+
+				cases.push_back(BenchCase{ name, mode, 8, &BENCH_SIZES[1], kernel });
+
+			}
+
+		}
+
+	}
+
+	if (options.scaling)
+
+	{
+
+		// 1, 2, 4 ... threads up to --threads, on a fresh pool each
+		std::printf("%-28s %7s %10s %10s %8s\n", "case", "threads", "median ms", "Mpix/s", "speedup");
+
+		for (const BenchCase &c : cases)
+
+		{
+
+			double single_ms = 0.0;
+
+			for (int t = 1; t <= threads; t = t < threads && t * 2 > threads ? threads : t * 2)
+
+			{
+
+				BenchPool scaling_pool(t);
+
+				const BenchResult r = RunCase(scaling_pool, options, c);
+
+				single_ms = t == 1 ? r.median_ms : single_ms;
+
+				std::printf("%-28s %7d %10.3f %10.1f %7.2fx\n", c.name.c_str(), t, r.median_ms, r.mpix_per_s, single_ms / r.median_ms);
+
+				std::fflush(stdout);
+
+			}
+
+		}
+
+		return 0;
+
+	}
+
+	std::printf("%-28s %-7s %6s %-5s %10s %10s", "case", "mode", "depth", "size", "median ms", "Mpix/s");
+
+	std::printf(compare ? " %10s %8s\n" : "\n", "baseline", "change");
+
+	const bool recording = !compare && !options.json_path.empty();
+
+	std::vector<BenchResult> results;
+
+	std::vector<std::string> regressed;
+
+	for (const BenchCase &c : cases)
+
+	{
+
+		BenchResult r = RunCase(pool, options, c);
+
+		const double *base = compare ? FindBaseline(baseline, c.name) : nullptr;
+
+		const double floor = base != nullptr ? *base * (1.0 - options.threshold * 0.01) : 0.0;
+
+		if (recording)
+
+		{
+
+			// A baseline is the typical run, not the luckiest one
+			std::vector<BenchResult> tries(1, r);
+
+			for (int retry = 0; retry < options.retries; ++retry)
+
+			{
+
+				tries.push_back(RunCase(pool, options, c));
+
+			}
+
+			std::sort(tries.begin(), tries.end(), [](const BenchResult &a, const BenchResult &b) { return a.mpix_per_s < b.mpix_per_s; });
+
+			r = tries[tries.size() / 2];
+
+		}
+
+		// Confirm a slow case before blaming the code for it
+		for (int retry = 0; retry < options.retries && r.mpix_per_s < floor; ++retry)
+
+		{
+
+			const BenchResult again = RunCase(pool, options, c);
+
+			r = again.mpix_per_s > r.mpix_per_s ? again : r;
+
+		}
+
+		results.push_back(r);
+
+		std::printf("%-28s %-7s %6d %-5s %10.3f %10.1f", c.name.c_str(), MODE_NAMES[c.mode], c.depth, c.size->name, r.median_ms, r.mpix_per_s);
+
+		if (base != nullptr)
+
+		{
+
+			const bool slow = r.mpix_per_s < floor;
+
+			std::printf(" %10.1f %+7.1f%%%s\n", *base, (r.mpix_per_s / *base - 1.0) * 100.0, slow ? "  REGRESSED" : "");
+
+			if (slow)
+
+			{
+
+				regressed.push_back(c.name);
+
+			}
+
+		}
+
+		else
+
+		{
+
+			std::printf(compare ? " %10s\n" : "\n", "new");
+
+		}
+
+		std::fflush(stdout);
+
+	}
+
+	if (!options.json_path.empty() && !WriteJson(options.json_path, options, threads, cpu, cases, results))
+
+	{
+
+		std::fprintf(stderr, "cannot write %s\n", options.json_path.c_str());
+
+		return 2;
+
+	}
+
+	if (!regressed.empty())
+
+	{
+
+		std::printf("\n%d of %d cases regressed more than %.1f%% below %s:", static_cast<int>(regressed.size()), static_cast<int>(cases.size()), options.threshold, options.baseline_path.c_str());
+
+		for (const std::string &name : regressed)
+
+		{
+
+			std::printf(" %s", name.c_str());
+
+		}
+
+		std::printf("\n");
+
+		return 1;
+
+	}
+
+	return 0;
+
+}
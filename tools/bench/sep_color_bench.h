@@ -0,0 +1,310 @@
+#pragma once
+
+#ifndef SEP_COLOR_BENCH_H
+#define SEP_COLOR_BENCH_H
+
+// Shared by sep_color_bench and sep_color_check: RGBA pixel types of each
+// depth, the persistent thread pool that stands in for the host's worker
+// threads, and the test image and output hash both programs use.
+
+#include "sep_color_Scheduler.h"
+
+#include <condition_variable>
+
+#include <cstdint>
+
+#include <cstring>
+
+#include <functional>
+
+#include <mutex>
+
+#include <thread>
+
+#include <vector>
+
+namespace SepColor {
+
+// RGBA pixels of each depth (8 and 16-bit use AE's 255 / 32768 scale)
+
+struct BenchPixel8
+{
+	std::uint8_t alpha, red, green, blue;
+};
+
+struct BenchPixel16
+{
+	std::uint16_t alpha, red, green, blue;
+};
+
+struct BenchPixel32
+{
+	float alpha, red, green, blue;
+};
+
+template<>
+
+struct PixelTraits<BenchPixel8>
+
+{
+
+	using ChannelType = std::uint8_t;
+
+	using PixelType = BenchPixel8;
+
+	static constexpr float MAX_CHANNEL = Constants::COLOR_8BIT_MAX;
+
+	static constexpr bool IsFloat = false;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return BlendFixed(src, dst, QuantizeCoverage(coverage));
+
+	}
+
+};
+
+template<>
+
+struct PixelTraits<BenchPixel16>
+
+{
+
+	using ChannelType = std::uint16_t;
+
+	using PixelType = BenchPixel16;
+
+	static constexpr float MAX_CHANNEL = Constants::COLOR_16BIT_MAX;
+
+	static constexpr bool IsFloat = false;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return BlendFixed(src, dst, QuantizeCoverage(coverage));
+
+	}
+
+};
+
+template<>
+
+struct PixelTraits<BenchPixel32>
+
+{
+
+	using ChannelType = float;
+
+	using PixelType = BenchPixel32;
+
+	static constexpr float MAX_CHANNEL = 1.0f;
+
+	static constexpr bool IsFloat = true;
+
+	static inline ChannelType Blend(ChannelType src, ChannelType dst, float coverage)
+
+	{
+
+		return src + (dst - src) * coverage;
+
+	}
+
+};
+
+} // namespace SepColor
+
+// -------------------------------------------------------------
+
+// Thread pool: every worker runs the job body once per frame
+
+// -------------------------------------------------------------
+
+class BenchPool
+{
+public:
+	explicit BenchPool(int threads)
+	{
+		for (int i = 1; i < threads; ++i)
+
+		{
+
+			workers_.emplace_back([this] { Loop(); });
+
+		}
+	}
+
+	~BenchPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			quit_ = true;
+		}
+
+		wake_.notify_all();
+
+		for (std::thread &t : workers_)
+
+		{
+
+			t.join();
+
+		}
+	}
+
+	int Threads() const
+	{
+		return static_cast<int>(workers_.size()) + 1;
+	}
+
+	// Run body() on every pool thread and the caller; returns when all are done
+	template<typename Body>
+	void Run(Body &&body)
+	{
+		std::function<void()> task(body);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			task_ = &task;
+
+			pending_ = static_cast<int>(workers_.size());
+
+			++generation_;
+		}
+
+		wake_.notify_all();
+
+		task();
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		done_.wait(lock, [this] { return pending_ == 0; });
+
+		task_ = nullptr;
+	}
+
+private:
+	void Loop()
+	{
+		std::uint64_t seen = 0;
+
+		for (;;)
+
+		{
+
+			std::function<void()> *task = nullptr;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+
+				wake_.wait(lock, [&] { return quit_ || generation_ != seen; });
+
+				if (quit_)
+
+				{
+
+					return;
+
+				}
+
+				seen = generation_;
+
+				task = task_;
+			}
+
+			(*task)();
+
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (--pending_ == 0)
+
+			{
+
+				done_.notify_one();
+
+			}
+
+		}
+	}
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	std::function<void()> *task_ = nullptr;
+	std::uint64_t generation_ = 0;
+	int pending_ = 0;
+	bool quit_ = false;
+};
+
+// Opaque gradient with every 7th pixel transparent
+template<typename PixelType>
+
+inline void FillSource(std::vector<PixelType> &pixels, int width, int height)
+
+{
+
+	using Channel = typename SepColor::PixelTraits<PixelType>::ChannelType;
+
+	const float max_channel = SepColor::PixelTraits<PixelType>::MAX_CHANNEL;
+
+	for (int y = 0; y < height; ++y)
+
+	{
+
+		for (int x = 0; x < width; ++x)
+
+		{
+
+			const std::size_t i = static_cast<std::size_t>(y) * width + x;
+
+			PixelType &p = pixels[i];
+
+			p.alpha = static_cast<Channel>(i % 7 == 0 ? 0.0f : max_channel);
+
+			p.red = static_cast<Channel>(max_channel * static_cast<float>(x) / static_cast<float>(width));
+
+			p.green = static_cast<Channel>(max_channel * static_cast<float>(y) / static_cast<float>(height));
+
+			p.blue = static_cast<Channel>(max_channel * 0.5f);
+
+		}
+
+	}
+
+}
+
+// FNV-1a over the visible pixels, row by row (ignores row padding)
+template<typename PixelType>
+
+inline std::uint64_t HashView(const SepColor::ImageView<PixelType> &view)
+
+{
+
+	std::uint64_t hash = 14695981039346656037ull;
+
+	for (int y = 0; y < view.height; ++y)
+
+	{
+
+		const unsigned char *bytes = reinterpret_cast<const unsigned char *>(view.Row(y));
+
+		for (std::size_t i = 0; i < static_cast<std::size_t>(view.width) * sizeof(PixelType); ++i)
+
+		{
+
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+		}
+
+	}
+
+	return hash;
+
+}
+
+#endif // SEP_COLOR_BENCH_H
@@ -0,0 +1,2261 @@
+// Correctness checks for the sep_color core (make test).
+// Each check renders through the same public API, kernels and scheduler as
+// the plugins and compares against a reference: the per-pixel formula, the
+// 32-bit float path, or the output of another ISA / thread count. Prints one
+// PASS / FAIL line per check and exits with 1 when any check fails. No host
+// SDK is needed; see Makefile.
+//
+//   sep_color_check [--filter TEXT] [--threads N]
+
+#include "sep_color_bench.h"
+
+#include "sep_color_Half.h"
+
+#include "sep_color_Planar.h"
+
+#include "sep_color_Preview.h"
+
+#include <algorithm>
+
+#include <chrono>
+
+#include <atomic>
+
+#include <cerrno>
+
+#include <cmath>
+
+#include <cstdarg>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <memory>
+
+#include <random>
+
+#include <string>
+
+#include <vector>
+
+using namespace SepColor;
+
+// -------------------------------------------------------------
+
+// Allocation counter
+
+// -------------------------------------------------------------
+
+// glibc: malloc and friends are interposed for the whole process (operator
+// new included) and counted, then forwarded to the C library. Elsewhere the
+// no-allocation check is skipped.
+
+#if defined(__GLIBC__)
+#define SEPCOLOR_CHECK_COUNTS_ALLOCATIONS 1
+
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+
+void *__libc_calloc(std::size_t count, std::size_t size);
+
+void *__libc_realloc(void *pointer, std::size_t size);
+
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+
+}
+
+static std::atomic<long> g_allocations(0);
+
+extern "C" void *malloc(std::size_t size) noexcept
+
+{
+
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return __libc_malloc(size);
+
+}
+
+extern "C" void *calloc(std::size_t count, std::size_t size) noexcept
+
+{
+
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return __libc_calloc(count, size);
+
+}
+
+extern "C" void *realloc(void *pointer, std::size_t size) noexcept
+
+{
+
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return __libc_realloc(pointer, size);
+
+}
+
+extern "C" void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+
+{
+
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return __libc_memalign(alignment, size);
+
+}
+
+extern "C" int posix_memalign(void **pointer, std::size_t alignment, std::size_t size) noexcept
+
+{
+
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	*pointer = __libc_memalign(alignment, size);
+
+	return *pointer != nullptr ? 0 : ENOMEM;
+
+}
+#endif
+
+struct CheckOptions
+{
+	std::string filter;
+	int threads = 0;								// 0: all hardware threads, at least 4
+};
+
+static CheckOptions g_options;
+
+static int g_failures = 0;
+
+// Report a failed expectation; the first few per check are printed
+static void Fail(const char *format, ...)
+
+{
+
+	if (++g_failures <= 8)
+
+	{
+
+		std::va_list args;
+
+		va_start(args, format);
+
+		std::printf("    ");
+
+		std::vprintf(format, args);
+
+		std::printf("\n");
+
+		va_end(args);
+
+	}
+
+}
+
+static int CheckThreads()
+
+{
+
+	return g_options.threads > 0 ? g_options.threads : std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+
+}
+
+// -------------------------------------------------------------
+
+// Row pipeline (RenderRows) against the per-pixel formula
+
+// -------------------------------------------------------------
+
+// Every output pixel equals ShadePixel(in, color, Coverage(x, y)), the
+// per-pixel path the span kernels replaced, bit for bit
+template<typename PixelType>
+
+static void CheckRowsDepth(const PixelType &color)
+
+{
+
+	const int w = 613;
+
+	const int h = 411;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h), dst(src.size());
+
+	FillSource(src, w, h);
+
+	const ImageView<const PixelType> in(src.data(), w, h, w * sizeof(PixelType), -40, 25);
+
+	const ImageView<PixelType> out(dst.data(), w, h, w * sizeof(PixelType), -40, 25);
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage = COVERAGE_HARD; coverage <= COVERAGE_SMOOTHSTEP; ++coverage)
+
+		{
+
+			for (float ds : { 1.0f, 2.0f })
+
+			{
+
+				const Geometry geom = MakeGeometry(mode, 250.5, 230.25, 1.9f, 170.0f, ds, ds, coverage, 7.0f);
+
+				RenderView(in, out, geom, color);
+
+				for (int y = 0; y < h; ++y)
+
+				{
+
+					for (int x = 0; x < w; ++x)
+
+					{
+
+						PixelType expected;
+
+						ShadePixel(in.Row(y)[x], expected, color, Coverage(geom, x - 40, y + 25));
+
+						if (std::memcmp(&expected, &out.Row(y)[x], sizeof(PixelType)) != 0)
+
+						{
+
+							Fail("%d-byte pixels mode %d coverage %d downsample %g: pixel (%d, %d) differs from the per-pixel path",
+								static_cast<int>(sizeof(PixelType)), mode, coverage, ds, x, y);
+
+						}
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+static void CheckRowsVsPerPixel()
+
+{
+
+	CheckRowsDepth(BenchPixel8{ 255, 10, 250, 128 });
+
+	CheckRowsDepth(BenchPixel16{ 32768, 1000, 32000, 16384 });
+
+	CheckRowsDepth(BenchPixel32{ 1.0f, 0.1f, 0.9f, 0.5f });
+
+}
+
+// -------------------------------------------------------------
+
+// ISA x thread count (sep_color_Simd.h, sep_color_Scheduler.h)
+
+// -------------------------------------------------------------
+
+template<typename PixelType>
+
+static std::uint64_t RenderHash(BenchPool &pool, const std::vector<PixelType> &src, std::vector<PixelType> &dst, int w, int h, const Geometry &geom, const PixelType &color)
+
+{
+
+	const ImageView<const PixelType> src_view(src.data(), w, h, w * sizeof(PixelType), 17, -9);
+
+	const ImageView<PixelType> dst_view(dst.data(), w, h, w * sizeof(PixelType), 17, -9);
+
+	std::fill(dst.begin(), dst.end(), PixelType());
+
+	RenderJob<PixelType> job(src_view, dst_view, geom, color);
+
+	pool.Run([&job] { RunRenderWorker(job); });
+
+	return HashView(ImageView<const PixelType>(dst_view));
+
+}
+
+// Every ISA this CPU runs, on one thread and on several, writes the same
+// 8 and 16-bit frames as the scalar kernels on one thread
+template<typename PixelType>
+
+static void CheckIsaMatrixDepth(const std::vector<SimdIsa> &isas, BenchPool *const pools[2], const int threads[2])
+
+{
+
+	const int w = 1031;
+
+	const int h = 587;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h), dst(src.size());
+
+	FillSource(src, w, h);
+
+	PixelType color;
+
+	color.alpha = static_cast<typename PixelTraits<PixelType>::ChannelType>(PixelTraits<PixelType>::MAX_CHANNEL);
+
+	color.red = color.alpha;
+
+	color.green = static_cast<typename PixelTraits<PixelType>::ChannelType>(PixelTraits<PixelType>::MAX_CHANNEL * 0.25f);
+
+	color.blue = 0;
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage = COVERAGE_HARD; coverage <= COVERAGE_SMOOTHSTEP; ++coverage)
+
+		{
+
+			const Geometry geom = MakeGeometry(mode, 530.25, 280.5, 0.35f, 230.0f, 1.0f, 1.0f, coverage, 6.0f);
+
+			SetSimdIsa(SIMD_SCALAR);
+
+			const std::uint64_t reference = RenderHash(*pools[0], src, dst, w, h, geom, color);
+
+			for (SimdIsa isa : isas)
+
+			{
+
+				SetSimdIsa(isa);
+
+				for (int t = 0; t < 2; ++t)
+
+				{
+
+					const std::uint64_t hash = RenderHash(*pools[t], src, dst, w, h, geom, color);
+
+					if (hash != reference)
+
+					{
+
+						Fail("%d-bit mode %d coverage %d: ISA %d on %d threads hashes %016llx, scalar on 1 thread %016llx", static_cast<int>(sizeof(typename PixelTraits<PixelType>::ChannelType) * 8),
+							mode, coverage, static_cast<int>(isa), threads[t], static_cast<unsigned long long>(hash), static_cast<unsigned long long>(reference));
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+static void CheckIsaMatrix()
+
+{
+
+	std::vector<SimdIsa> isas;
+
+	for (int isa = SIMD_SCALAR; isa <= SIMD_NEON; ++isa)
+
+	{
+
+		if (SetSimdIsa(static_cast<SimdIsa>(isa)) == isa)
+
+		{
+
+			isas.push_back(static_cast<SimdIsa>(isa));
+
+		}
+
+	}
+
+	std::printf("     ISAs:");
+
+	for (SimdIsa isa : isas)
+
+	{
+
+		std::printf(" %d", static_cast<int>(isa));
+
+	}
+
+	std::printf("\n");
+
+	const int threads[2] = { 1, CheckThreads() };
+
+	BenchPool single(threads[0]);
+
+	BenchPool multi(threads[1]);
+
+	BenchPool *const pools[2] = { &single, &multi };
+
+	CheckIsaMatrixDepth<BenchPixel8>(isas, pools, threads);
+
+	CheckIsaMatrixDepth<BenchPixel16>(isas, pools, threads);
+
+	SetSimdIsa(DetectSimdIsa());
+
+}
+
+// -------------------------------------------------------------
+
+// Incremental re-render (RenderRowsDelta, RenderJob::prev_geom)
+
+// -------------------------------------------------------------
+
+// A delta render on top of the previous frame equals a full render of the
+// new geometry, byte for byte, through the threaded scheduler. The edge
+// mostly moves a few pixels per frame; every few frames the mode, coverage
+// mode or render scale jumps as well
+template<typename PixelType>
+
+static void CheckDeltaDepth(BenchPool &pool, const PixelType &color)
+
+{
+
+	const int w = 517;
+
+	const int h = 301;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h), full(src.size()), delta(src.size());
+
+	FillSource(src, w, h);
+
+	const ImageView<const PixelType> in(src.data(), w, h, w * sizeof(PixelType), -23, 41);
+
+	const ImageView<PixelType> full_out(full.data(), w, h, w * sizeof(PixelType), -23, 41);
+
+	const ImageView<PixelType> delta_out(delta.data(), w, h, w * sizeof(PixelType), -23, 41);
+
+	std::mt19937 rng(11);
+
+	const auto uniform = [&rng](double lo, double hi) { return lo + (hi - lo) * static_cast<double>(rng() % 10001) / 10000.0; };
+
+	int mode = MODE_LINE;
+
+	int coverage = COVERAGE_LINEAR;
+
+	float ds = 1.0f;
+
+	double anchor_x = 230.0;
+
+	double anchor_y = 180.0;
+
+	double angle = 0.4;
+
+	double radius = 120.0;
+
+	Geometry prev = MakeGeometry(mode, anchor_x, anchor_y, static_cast<float>(angle), static_cast<float>(radius), ds, ds, coverage, 5.0f);
+
+	RenderView(in, delta_out, prev, color);
+
+	for (int frame = 0; frame < 120; ++frame)
+
+	{
+
+		if (rng() % 6 == 0)
+
+		{
+
+			mode = MODE_LINE + static_cast<int>(rng() % 2);
+
+			coverage = COVERAGE_HARD + static_cast<int>(rng() % (COVERAGE_SMOOTHSTEP - COVERAGE_HARD + 1));
+
+			ds = rng() % 3 == 0 ? 2.0f : 1.0f;
+
+		}
+
+		anchor_x += uniform(-6.0, 6.0);
+
+		anchor_y += uniform(-6.0, 6.0);
+
+		angle += uniform(-0.05, 0.05);
+
+		radius = std::max(1.0, radius + uniform(-8.0, 8.0));
+
+		const Geometry geom = MakeGeometry(mode, anchor_x, anchor_y, static_cast<float>(angle), static_cast<float>(radius), ds, ds, coverage, 5.0f);
+
+		RenderView(in, full_out, geom, color);
+
+		RenderJob<PixelType> job(in, delta_out, geom, color);
+
+		job.prev_geom = &prev;
+
+		pool.Run([&job] { RunRenderWorker(job); });
+
+		if (std::memcmp(full.data(), delta.data(), full.size() * sizeof(PixelType)) != 0)
+
+		{
+
+			Fail("%d-byte pixels frame %d (mode %d coverage %d downsample %g): delta render differs from the full render",
+				static_cast<int>(sizeof(PixelType)), frame, mode, coverage, ds);
+
+			return;
+
+		}
+
+		prev = geom;
+
+	}
+
+}
+
+static void CheckDelta()
+
+{
+
+	BenchPool pool(CheckThreads());
+
+	CheckDeltaDepth(pool, BenchPixel8{ 255, 10, 250, 128 });
+
+	CheckDeltaDepth(pool, BenchPixel16{ 32768, 1000, 32000, 16384 });
+
+	CheckDeltaDepth(pool, BenchPixel32{ 1.0f, 0.1f, 0.9f, 0.5f });
+
+}
+
+// -------------------------------------------------------------
+
+// Steady-state frames do not allocate
+
+// -------------------------------------------------------------
+
+// Frames on `pool`, or with fresh_threads on new worker threads every frame
+// (hosts need not keep their workers between frames)
+template<typename PixelType>
+
+static void CheckNoAllocationDepth(int threads, bool fresh_threads)
+
+{
+
+#if SEPCOLOR_CHECK_COUNTS_ALLOCATIONS
+	const int w = 1280;
+
+	const int h = 720;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h), dst(src.size());
+
+	FillSource(src, w, h);
+
+	PixelType color;
+
+	color.alpha = static_cast<typename PixelTraits<PixelType>::ChannelType>(PixelTraits<PixelType>::MAX_CHANNEL);
+
+	color.red = color.alpha;
+
+	color.green = 0;
+
+	color.blue = 0;
+
+	const ImageView<const PixelType> src_view(src.data(), w, h, w * sizeof(PixelType));
+
+	const ImageView<PixelType> dst_view(dst.data(), w, h, w * sizeof(PixelType));
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage = COVERAGE_HARD; coverage <= COVERAGE_SMOOTHSTEP; ++coverage)
+
+		{
+
+			// One warm-up frame, then every frame, as the plugins render them,
+			// must run on memory that already exists
+			long allocations = 0;
+
+			std::unique_ptr<BenchPool> pool(new BenchPool(threads));
+
+			for (int frame = 0; frame < 4; ++frame)
+
+			{
+
+				if (fresh_threads && frame > 0)
+
+				{
+
+					pool.reset(new BenchPool(threads));
+
+				}
+
+				const long before = g_allocations.load();
+
+				const Geometry geom = MakeGeometry(mode, 640.5 + frame, 360.0, 0.5f + frame * 0.1f, 250.0f, 1.0f, 1.0f, coverage, 3.0f);
+
+				RenderJob<PixelType> job(src_view, dst_view, geom, color);
+
+				pool->Run([&job] { RunRenderWorker(job); });
+
+				allocations += frame > 0 ? g_allocations.load() - before : 0;
+
+			}
+
+			if (allocations != 0)
+
+			{
+
+				Fail("%d-byte pixels, %d %s threads, mode %d coverage %d: %ld allocations in 3 frames", static_cast<int>(sizeof(PixelType)), threads,
+					fresh_threads ? "new" : "persistent", mode, coverage, allocations);
+
+			}
+
+		}
+
+	}
+#else
+	(void)threads;
+
+	(void)fresh_threads;
+#endif
+
+}
+
+static void CheckNoAllocation()
+
+{
+
+#if !SEPCOLOR_CHECK_COUNTS_ALLOCATIONS
+	std::printf("     allocation counting needs glibc; skipped\n");
+#endif
+
+	for (int threads : { 1, 2, CheckThreads() })
+
+	{
+
+		for (bool fresh_threads : { false, true })
+
+		{
+
+			CheckNoAllocationDepth<BenchPixel8>(threads, fresh_threads);
+
+			CheckNoAllocationDepth<BenchPixel16>(threads, fresh_threads);
+
+			CheckNoAllocationDepth<BenchPixel32>(threads, fresh_threads);
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Cancellation (RenderJob::poll)
+
+// -------------------------------------------------------------
+
+// Stand-in for the host's abort check (AE: PF_ABORT; OFX: abort())
+struct MockHost
+{
+	std::atomic<bool> cancel{false};
+	std::atomic<int> polls{0};
+};
+
+static int MockPoll(void *refcon, int bands_done, int bands_total)
+
+{
+
+	(void)bands_done;
+
+	(void)bands_total;
+
+	MockHost *host = static_cast<MockHost *>(refcon);
+
+	host->polls.fetch_add(1);
+
+	return host->cancel.load() ? 1 : 0;
+
+}
+
+// Render on `threads` threads with this one as the polling thread 0, which
+// with late_poller only joins once the others have taken every band.
+// Cancels `cancel_ms` after the start (< 0: never). Returns milliseconds.
+static double RunCancelFrame(RenderJob<BenchPixel8> &job, MockHost &host, int threads, bool late_poller, double cancel_ms)
+
+{
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+
+	for (int i = 1; i < threads; ++i)
+
+	{
+
+		workers.emplace_back([&job] { RunRenderWorker(job); });
+
+	}
+
+	std::thread canceller;
+
+	if (cancel_ms >= 0.0)
+
+	{
+
+		canceller = std::thread([&host, start, cancel_ms] {
+
+			std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<long long>(cancel_ms * 1e3)));
+
+			host.cancel.store(true);
+
+		});
+
+	}
+
+	while (late_poller && job.next_band.load() < job.bands)
+
+	{
+
+		std::this_thread::yield();
+
+	}
+
+	RunRenderWorker(job, true);
+
+	for (std::thread &t : workers)
+
+	{
+
+		t.join();
+
+	}
+
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (canceller.joinable())
+
+	{
+
+		canceller.join();
+
+	}
+
+	return ms;
+
+}
+
+// A 16K frame (15360 x 8640, 8-bit, in place) cancelled a fifth of the way
+// through stops within two band times of the cancel on 1 and N threads; a
+// cancel is reported even when thread 0 starts after every band is taken;
+// and an uncancelled frame completes with a bounded number of polls.
+static void CheckCancel()
+
+{
+
+	const int w = 15360;
+
+	const int h = 8640;
+
+	std::vector<BenchPixel8> pixels(static_cast<std::size_t>(w) * h);
+
+	FillSource(pixels, w, h);
+
+	const ImageView<BenchPixel8> view(pixels.data(), w, h, w * sizeof(BenchPixel8));
+
+	const Geometry geom = MakeGeometry(MODE_CIRCLE, 7600.0, 4300.0, 0.0f, 4000.0f, 1.0f, 1.0f, COVERAGE_GAUSSIAN, 6.0f);
+
+	const BenchPixel8 color = { 255, 255, 0, 0 };
+
+	for (int threads : { 1, CheckThreads() })
+
+	{
+
+		MockHost full_host;
+
+		RenderJob<BenchPixel8> full(view, view, geom, color);
+
+		full.poll = MockPoll;
+
+		full.poll_refcon = &full_host;
+
+		const double full_ms = RunCancelFrame(full, full_host, threads, false, -1.0);
+
+		const int max_polls = full.bands * (RenderJob<BenchPixel8>::POLL_SLICES + 1);
+
+		if (full.status.load() != 0 || full.bands_done.load() != full.bands || full_host.polls.load() == 0 || full_host.polls.load() > max_polls)
+
+		{
+
+			Fail("%d threads, no cancel: status %d, %d of %d bands, %d polls", threads, full.status.load(), full.bands_done.load(), full.bands, full_host.polls.load());
+
+		}
+
+		// Every worker may be one band into its work when the cancel lands
+		const double band_ms = full_ms * threads / full.bands;
+
+		MockHost host;
+
+		RenderJob<BenchPixel8> job(view, view, geom, color);
+
+		job.poll = MockPoll;
+
+		job.poll_refcon = &host;
+
+		const double cancel_ms = full_ms * 0.2;
+
+		const double ms = RunCancelFrame(job, host, threads, false, cancel_ms);
+
+		std::printf("     %d threads: frame %.1f ms, %d bands; cancelled at %.1f ms, returned at %.1f ms\n", threads, full_ms, job.bands, cancel_ms, ms);
+
+		if (job.status.load() != 1 || ms > cancel_ms + 2.0 * band_ms + 20.0)
+
+		{
+
+			Fail("%d threads: cancel at %.1f ms, returned at %.1f ms (bound %.1f ms), status %d", threads, cancel_ms, ms, cancel_ms + 2.0 * band_ms + 20.0, job.status.load());
+
+		}
+
+		if (threads < 2)
+
+		{
+
+			continue;
+
+		}
+
+		MockHost late_host;
+
+		RenderJob<BenchPixel8> late(view, view, geom, color);
+
+		late.poll = MockPoll;
+
+		late.poll_refcon = &late_host;
+
+		RunCancelFrame(late, late_host, threads, true, cancel_ms);
+
+		if (late.status.load() != 1)
+
+		{
+
+			Fail("%d threads, thread 0 late: cancel not reported (%d polls)", threads, late_host.polls.load());
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Per-instance preview governors (sep_color_Preview.h)
+
+// -------------------------------------------------------------
+
+// Two instances degrade independently; a slot lives while any copy holds a
+// reference and comes back reset; ids past CAPACITY share the fallback
+static void CheckPreviewGovernors()
+
+{
+
+	std::unique_ptr<PreviewGovernorMap> map(new PreviewGovernorMap());
+
+	map->Acquire(11);
+
+	map->Acquire(22);
+
+	map->Find(11).Report(PREVIEW_FULL, 50.0f, 10.0f);
+
+	if (map->Find(11).Level() != PREVIEW_LINEAR || map->Find(22).Level() != PREVIEW_FULL || &map->Find(11) == &map->Find(22))
+
+	{
+
+		Fail("an overrun of instance 11 moved instance 22 to level %d", map->Find(22).Level());
+
+	}
+
+	// A render-thread copy of instance 11 comes and goes
+	map->Acquire(11);
+
+	map->Release(11);
+
+	if (&map->Find(11) == &map->Find(0) || map->Find(11).Level() != PREVIEW_LINEAR)
+
+	{
+
+		Fail("instance 11 lost its governor when a copy was set down");
+
+	}
+
+	map->Release(11);
+
+	if (&map->Find(11) != &map->Find(0))
+
+	{
+
+		Fail("instance 11 still has a slot after its last setdown");
+
+	}
+
+	map->Acquire(33);
+
+	if (map->Find(33).Level() != PREVIEW_FULL)
+
+	{
+
+		Fail("a reused slot kept level %d", map->Find(33).Level());
+
+	}
+
+	for (std::uint64_t key = 100; key < 100 + PreviewGovernorMap::CAPACITY; ++key)
+
+	{
+
+		map->Acquire(key);
+
+	}
+
+	if (&map->Find(22) == &map->Find(0) || &map->Find(33) == &map->Find(0))
+
+	{
+
+		Fail("a full table dropped a live instance");
+
+	}
+
+	if (&map->Find(100 + PreviewGovernorMap::CAPACITY - 1) != &map->Find(0))
+
+	{
+
+		Fail("an instance past CAPACITY got a slot of its own");
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Draft coverage and render stats
+
+// -------------------------------------------------------------
+
+// Render stats of one view whose every pixel is `pixel`
+template<typename PixelType>
+
+static RenderStats StatsOf(const PixelType &pixel, const PixelType &color, int coverage)
+
+{
+
+	const int w = 257;
+
+	const int h = 64;
+
+	std::vector<PixelType> src(static_cast<std::size_t>(w) * h, pixel), dst(src.size());
+
+	const ImageView<const PixelType> in(src.data(), w, h, w * sizeof(PixelType));
+
+	const ImageView<PixelType> out(dst.data(), w, h, w * sizeof(PixelType));
+
+	const Geometry geom = MakeGeometry(MODE_CIRCLE, 128.3, 31.7, 0.0f, 40.0f, 1.0f, 1.0f, coverage);
+
+	RowScratch scratch;
+
+	RenderStats stats;
+
+	RenderRows(in, out, geom, color, 0, h, scratch, &stats);
+
+	return stats;
+
+}
+
+// Drafts render with the hard edge, hash apart from every popup mode and
+// skip the transparent count; final frames count every zero-alpha pixel
+static void CheckDraftCoverage()
+
+{
+
+	if (DraftCoverage(COVERAGE_GAUSSIAN, 2.0f, 1.0f, false) != COVERAGE_HARD || DraftCoverage(COVERAGE_AREA, 1.0f, 1.0f, true) != COVERAGE_HARD)
+
+	{
+
+		Fail("a draft frame does not render with the hard edge");
+
+	}
+
+	if (DraftCoverage(COVERAGE_GAUSSIAN, 1.0f, 1.0f, false) != COVERAGE_GAUSSIAN)
+
+	{
+
+		Fail("a full-resolution final frame lost its coverage mode");
+
+	}
+
+	for (int coverage = COVERAGE_LINEAR; coverage <= COVERAGE_SMOOTHSTEP; ++coverage)
+
+	{
+
+		if (RenderFingerprint(coverage) == RenderFingerprint(COVERAGE_HARD))
+
+		{
+
+			Fail("coverage %d has the fingerprint of a draft frame", coverage);
+
+		}
+
+	}
+
+	const BenchPixel8 color = { 255, 255, 10, 200 };
+
+	const BenchPixel8 clear = { 0, 90, 120, 150 };
+
+	const RenderStats final_stats = StatsOf(clear, color, COVERAGE_LINEAR);
+
+	const std::uint64_t painted = final_stats.value[RenderStats::FILL_PX] + final_stats.value[RenderStats::BAND_PX];
+
+	if (painted == 0 || final_stats.value[RenderStats::TRANSPARENT_PX] != painted)
+
+	{
+
+		Fail("final frame: %llu transparent of %llu painted pixels", static_cast<unsigned long long>(final_stats.value[RenderStats::TRANSPARENT_PX]), static_cast<unsigned long long>(painted));
+
+	}
+
+	const RenderStats draft_stats = StatsOf(clear, color, COVERAGE_HARD);
+
+	if (draft_stats.value[RenderStats::TRANSPARENT_PX] != 0)
+
+	{
+
+		Fail("draft frame counted %llu transparent pixels", static_cast<unsigned long long>(draft_stats.value[RenderStats::TRANSPARENT_PX]));
+
+	}
+
+	// Half alphas are bit patterns: -0, negative and NaN are transparent too
+	PixelHalf half_color;
+
+	PixelTraits<PixelHalf>::ConvertColor8(255, 10, 200, half_color);
+
+	for (std::uint16_t alpha : { 0x0000, 0x8000, 0xBC00, 0x7E00, 0x3C00, 0x0001 })
+
+	{
+
+		const PixelHalf half_pixel = { 0x3800, 0x3400, 0x3000, alpha };
+
+		const RenderStats half_stats = StatsOf(half_pixel, half_color, COVERAGE_LINEAR);
+
+		const std::uint64_t half_painted = half_stats.value[RenderStats::FILL_PX] + half_stats.value[RenderStats::BAND_PX];
+
+		const std::uint64_t expected = alpha == 0x3C00 || alpha == 0x0001 ? 0 : half_painted;
+
+		if (half_stats.value[RenderStats::TRANSPARENT_PX] != expected)
+
+		{
+
+			Fail("half alpha 0x%04x: %llu transparent of %llu painted pixels", alpha, static_cast<unsigned long long>(half_stats.value[RenderStats::TRANSPARENT_PX]), static_cast<unsigned long long>(half_painted));
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Exact pixel-area coverage (COVERAGE_AREA)
+
+// -------------------------------------------------------------
+
+// Fraction of the pixel square at (x, y) inside the boundary, from a 64 x 64
+// grid of sample points, in double
+static double SampledArea(const Geometry &g, int x, int y)
+
+{
+
+	const int n = 64;
+
+	int inside = 0;
+
+	for (int i = 0; i < n; ++i)
+
+	{
+
+		for (int j = 0; j < n; ++j)
+
+		{
+
+			const double fx = (x - 0.5 + (i + 0.5) / n - g.anchor_x) * g.downsample_x;
+
+			const double fy = (y - 0.5 + (j + 0.5) / n - g.anchor_y) * g.downsample_y;
+
+			const bool in = g.mode == MODE_LINE ? fx * g.cs + fy * g.sn >= 0.0 : fx * fx + fy * fy <= static_cast<double>(g.radius) * g.radius;
+
+			inside += in ? 1 : 0;
+
+		}
+
+	}
+
+	return inside / static_cast<double>(n * n);
+
+}
+
+// Band pixels of COVERAGE_AREA follow the sampled area within 0.02 (0.005
+// on average, the sampling grid's own resolution); clear of the boundary
+// the coverage is 0 or 1. Random angles and radii, with downsampling.
+static void CheckAreaCoverage()
+
+{
+
+	std::mt19937 rng(2);
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		double max_error = 0.0, sum_error = 0.0;
+
+		int band = 0;
+
+		for (int it = 0; it < 24; ++it)
+
+		{
+
+			const float ds = it % 4 == 0 ? 2.0f : 1.0f;
+
+			const Geometry geom = MakeGeometry(mode, 50.0 + (rng() % 100) * 0.01, 50.0, (rng() % 3600) * 0.1f * Constants::DEG_TO_RAD, 8.0f + rng() % 40, ds, ds, COVERAGE_AREA);
+
+			for (int y = 0; y < 100; ++y)
+
+			{
+
+				for (int x = 0; x < 100; ++x)
+
+				{
+
+					// Pixels clear of the boundary need no sampling: 0 or 1
+					const double fx = (x - geom.anchor_x) * geom.downsample_x;
+
+					const double fy = (y - geom.anchor_y) * geom.downsample_y;
+
+					const double distance = mode == MODE_LINE ? fx * geom.cs + fy * geom.sn : geom.radius - std::sqrt(fx * fx + fy * fy);
+
+					const double truth = std::fabs(distance) > 1.5 * ds ? (distance > 0.0 ? 1.0 : 0.0) : SampledArea(geom, x, y);
+
+					const float coverage = Coverage(geom, x, y);
+
+					if (truth <= 0.0 || truth >= 1.0)
+
+					{
+
+						if (std::fabs(coverage - truth) > 0.02)
+
+						{
+
+							Fail("mode %d: pixel (%d, %d) outside the boundary band has coverage %f, sampled %f", mode, x, y, coverage, truth);
+
+						}
+
+						continue;
+
+					}
+
+					const double error = std::fabs(coverage - truth);
+
+					max_error = std::max(max_error, error);
+
+					sum_error += error;
+
+					++band;
+
+				}
+
+			}
+
+		}
+
+		std::printf("     mode %d: %d band pixels, max error %.4f, mean %.5f\n", mode, band, max_error, sum_error / band);
+
+		if (max_error > 0.02 || sum_error / band > 0.005)
+
+		{
+
+			Fail("mode %d: area coverage error max %.4f, mean %.5f", mode, max_error, sum_error / band);
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Subpixel anchors and downsampled previews
+
+// -------------------------------------------------------------
+
+// Red channel of a float render of black toward red: the coverage image
+static std::vector<float> CoverageImage(const Geometry &geom, int w, int h)
+
+{
+
+	std::vector<BenchPixel32> src(static_cast<std::size_t>(w) * h, BenchPixel32{ 1.0f, 0.0f, 0.0f, 0.0f }), dst(src.size());
+
+	RenderView(ImageView<const BenchPixel32>(src.data(), w, h, w * sizeof(BenchPixel32)), ImageView<BenchPixel32>(dst.data(), w, h, w * sizeof(BenchPixel32)), geom, BenchPixel32{ 1.0f, 1.0f, 0.0f, 0.0f });
+
+	std::vector<float> red(dst.size());
+
+	for (std::size_t i = 0; i < dst.size(); ++i)
+
+	{
+
+		red[i] = dst[i].red;
+
+	}
+
+	return red;
+
+}
+
+// 1/2 and 1/4 renders at 16.16 anchors and angles agree with the box-
+// decimated full render: no mean bias (the preview is not shifted), exact
+// area within 0.01 per pixel. Linear coverage keeps its ramp in full-res
+// pixels, so only its bias is checked. And the anchor's fraction moves the
+// boundary by that fraction, rather than snapping to whole pixels.
+static void CheckDownsampled()
+
+{
+
+	const int size = 512;
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage : { COVERAGE_LINEAR, COVERAGE_AREA })
+
+		{
+
+			for (int fraction : { 0, 24117, 52429 })
+
+			{
+
+				const double anchor_x = 200.0 + fraction / 65536.0;
+
+				const double anchor_y = 250.0 + 39977 / 65536.0;
+
+				const float angle = static_cast<float>(23.0 + 9001 / 65536.0) * Constants::DEG_TO_RAD;
+
+				const std::vector<float> full = CoverageImage(MakeGeometry(mode, anchor_x, anchor_y, angle, 150.3f, 1.0f, 1.0f, coverage), size, size);
+
+				for (int ds : { 2, 4 })
+
+				{
+
+					const int n = size / ds;
+
+					const std::vector<float> preview = CoverageImage(MakeGeometry(mode, anchor_x / ds, anchor_y / ds, angle, 150.3f, static_cast<float>(ds), static_cast<float>(ds), coverage), n, n);
+
+					double max_error = 0.0, bias = 0.0;
+
+					for (int y = 0; y < n; ++y)
+
+					{
+
+						for (int x = 0; x < n; ++x)
+
+						{
+
+							double decimated = 0.0;
+
+							for (int j = 0; j < ds; ++j)
+
+							{
+
+								for (int i = 0; i < ds; ++i)
+
+								{
+
+									decimated += full[static_cast<std::size_t>(y * ds + j) * size + x * ds + i];
+
+								}
+
+							}
+
+							decimated /= ds * ds;
+
+							const double error = preview[static_cast<std::size_t>(y) * n + x] - decimated;
+
+							max_error = std::max(max_error, std::fabs(error));
+
+							bias += error;
+
+						}
+
+					}
+
+					bias /= static_cast<double>(n) * n;
+
+					if (std::fabs(bias) > 1e-3 || (coverage == COVERAGE_AREA && max_error > 0.01))
+
+					{
+
+						Fail("mode %d coverage %d anchor x %.5f, 1/%d: max error %.4f, mean bias %+.5f", mode, coverage, anchor_x, ds, max_error, bias);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+	// A vertical line moved by a quarter pixel covers a quarter pixel more
+	// (or less) on every row
+	const int h = 64;
+
+	const std::vector<float> at = CoverageImage(MakeGeometry(MODE_LINE, 32.0, 32.0, 0.0f, 0.0f, 1.0f, 1.0f, COVERAGE_AREA), 64, h);
+
+	const std::vector<float> moved = CoverageImage(MakeGeometry(MODE_LINE, 32.25, 32.0, 0.0f, 0.0f, 1.0f, 1.0f, COVERAGE_AREA), 64, h);
+
+	double difference = 0.0;
+
+	for (std::size_t i = 0; i < at.size(); ++i)
+
+	{
+
+		difference += moved[i] - at[i];
+
+	}
+
+	if (std::fabs(std::fabs(difference) - 0.25 * h) > 1e-3 * h)
+
+	{
+
+		Fail("anchor moved by 0.25 px changes coverage by %.4f px per row", difference / h);
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// 30000-pixel layers (tile-relative coordinates)
+
+// -------------------------------------------------------------
+
+// Linear coverage of layer pixel (x, y) in double
+static double ReferenceLinear(const Geometry &g, int x, int y)
+
+{
+
+	const double fx = (x - g.anchor_x) * g.downsample_x;
+
+	const double fy = (y - g.anchor_y) * g.downsample_y;
+
+	const double distance = g.mode == MODE_LINE ? fx * g.cs + fy * g.sn : g.radius - std::sqrt(fx * fx + fy * fy);
+
+	return std::max(0.0, std::min(1.0, (distance / g.edge_width + 1.0) * 0.5));
+
+}
+
+// On a 30000 x 30000 layer, circles of radius up to 45000 and lines through
+// the far corner keep their coverage within 1e-5 of the double reference
+// (a float fx * fx + fy * fy pipeline is off by 1e-3 here), in Coverage(),
+// in the row kernels' CoverageRun() and in rendered 16-bit pixels.
+static void CheckLargeLayer()
+
+{
+
+	struct LargeCase
+	{
+		int mode;
+		double anchor_x, anchor_y;
+		float angle;
+		float radius;
+	};
+
+	static const LargeCase CASES[] = {
+		{ MODE_CIRCLE, 0.0, 0.0, 0.0f, 29990.0f },
+		{ MODE_CIRCLE, 0.0, 0.0, 0.0f, 42000.0f },
+		{ MODE_CIRCLE, 15000.0, 15000.0, 0.0f, 14990.0f },
+		{ MODE_CIRCLE, -5000.0, -5000.0, 0.0f, 45000.0f },
+		{ MODE_CIRCLE, 7.3, 3.1, 0.0f, 38000.0f },
+		{ MODE_CIRCLE, 0.0, 0.0, 0.0f, 20000.5f },
+		{ MODE_LINE, 29999.0, 29999.0, 2.1f, 0.0f },
+		{ MODE_LINE, 29999.5, 0.25, 0.7f, 0.0f }
+	};
+
+	const int size = 30000;
+
+	std::vector<float> coverage(size);
+
+	std::vector<BenchPixel16> src(size), dst(size);
+
+	FillSource(src, size, 1);
+
+	const BenchPixel16 color = { 32768, 32768, 8192, 0 };
+
+	for (const LargeCase &c : CASES)
+
+	{
+
+		const Geometry geom = MakeGeometry(c.mode, c.anchor_x, c.anchor_y, c.angle, c.radius, 1.0f, 1.0f);
+
+		double max_error = 0.0;
+
+		for (int y = 0; y < size; y += 97)
+
+		{
+
+			Span spans[MAX_ROW_SPANS];
+
+			const int n = ClassifyRow(geom, y, 0, size, spans);
+
+			bool band = false;
+
+			for (int s = 0; s < n; ++s)
+
+			{
+
+				if (spans[s].kind != SPAN_BAND)
+
+				{
+
+					for (int x : { spans[s].begin, (spans[s].begin + spans[s].end) / 2, spans[s].end - 1 })
+
+					{
+
+						if (std::fabs(ReferenceLinear(geom, x, y) - (spans[s].kind == SPAN_FILL ? 1.0 : 0.0)) > 1e-5)
+
+						{
+
+							Fail("mode %d anchor (%g, %g): pixel (%d, %d) in a %s span has coverage %f", c.mode, c.anchor_x, c.anchor_y, x, y,
+								spans[s].kind == SPAN_FILL ? "fill" : "copy", ReferenceLinear(geom, x, y));
+
+						}
+
+					}
+
+					continue;
+
+				}
+
+				band = true;
+
+				CoverageRun(geom, y, spans[s].begin, spans[s].end, coverage.data());
+
+				for (int x = spans[s].begin; x < spans[s].end; ++x)
+
+				{
+
+					const double reference = ReferenceLinear(geom, x, y);
+
+					max_error = std::max({ max_error, std::fabs(Coverage(geom, x, y) - reference), std::fabs(coverage[x - spans[s].begin] - reference) });
+
+				}
+
+			}
+
+			if (!band)
+
+			{
+
+				continue;
+
+			}
+
+			// One 30000-pixel row of the layer, rendered at its true origin
+			RenderRows(ImageView<const BenchPixel16>(src.data(), size, 1, size * sizeof(BenchPixel16), 0, y), ImageView<BenchPixel16>(dst.data(), size, 1, size * sizeof(BenchPixel16), 0, y), geom, color, 0, 1);
+
+			for (int x = 0; x < size; ++x)
+
+			{
+
+				const std::uint16_t expected = BlendFixed(src[x].red, color.red, QuantizeCoverage(static_cast<float>(ReferenceLinear(geom, x, y))));
+
+				if (std::abs(dst[x].red - expected) > 1)
+
+				{
+
+					Fail("mode %d anchor (%g, %g): pixel (%d, %d) red %d, expected %d", c.mode, c.anchor_x, c.anchor_y, x, y, dst[x].red, expected);
+
+				}
+
+			}
+
+		}
+
+		if (max_error > 1e-5)
+
+		{
+
+			Fail("mode %d anchor (%g, %g) radius %g: coverage error %.2e", c.mode, c.anchor_x, c.anchor_y, c.radius, max_error);
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// FP16 (sep_color_Half.h)
+
+// -------------------------------------------------------------
+
+// Scalar and F16C conversions agree: every half to float, and random floats
+// (plus near-ties in [0, 2]) back to half. NaN payloads may differ.
+static void CheckHalfConversions()
+
+{
+
+	for (std::uint32_t bits = 0; bits < 65536; ++bits)
+
+	{
+
+		const std::uint16_t h[4] = { static_cast<std::uint16_t>(bits), 0, 0, 0 };
+
+		float scalar[4], native[4];
+
+		half::ToFloat4Scalar(h, scalar);
+
+		half::ToFloat4(h, native);
+
+		if (std::memcmp(scalar, native, sizeof(float)) != 0)
+
+		{
+
+			Fail("half 0x%04x: scalar %g, native %g", bits, scalar[0], native[0]);
+
+		}
+
+	}
+
+	std::mt19937 rng(3);
+
+	for (int i = 0; i < 1000000; ++i)
+
+	{
+
+		float f;
+
+		const std::uint32_t bits = rng();
+
+		std::memcpy(&f, &bits, sizeof(f));
+
+		if (i % 2 != 0)
+
+		{
+
+			f = static_cast<float>(rng() % 200000) / 100000.0f - 0.3f;
+
+		}
+
+		const float v[4] = { f, f, f, f };
+
+		std::uint16_t scalar[4], native[4];
+
+		half::FromFloat4Scalar(v, scalar);
+
+		half::FromFloat4(v, native);
+
+		const bool nan = (scalar[0] & 0x7C00u) == 0x7C00u && (scalar[0] & 0x3FFu) != 0;
+
+		if (scalar[0] != native[0] && !nan)
+
+		{
+
+			Fail("float %.9g: scalar 0x%04x, native 0x%04x", f, scalar[0], native[0]);
+
+		}
+
+	}
+
+}
+
+// A half render equals the 32-bit float render of the same (half-exact)
+// inputs, rounded once to half: the FP16 path blends in float and narrows
+// each band pixel once, and copies / fills move half bits untouched.
+static void CheckHalfVsFloat()
+
+{
+
+	const int w = 301;
+
+	const int h = 203;
+
+	std::vector<PixelHalf> half_src(static_cast<std::size_t>(w) * h), half_dst(half_src.size());
+
+	std::vector<BenchPixel32> float_src(half_src.size()), float_dst(half_src.size());
+
+	std::mt19937 rng(7);
+
+	for (std::size_t i = 0; i < half_src.size(); ++i)
+
+	{
+
+		float rgba[4];
+
+		for (float &c : rgba)
+
+		{
+
+			c = static_cast<float>(rng() % 1001) / 1000.0f;
+
+		}
+
+		rgba[3] = i % 7 == 0 ? 0.0f : rgba[3];
+
+		half::FromFloat4Scalar(rgba, &half_src[i].red);
+
+		half::ToFloat4Scalar(&half_src[i].red, rgba);
+
+		float_src[i] = BenchPixel32{ rgba[3], rgba[0], rgba[1], rgba[2] };
+
+	}
+
+	PixelHalf half_color;
+
+	PixelTraits<PixelHalf>::ConvertColor8(255, 10, 200, half_color);
+
+	float color_rgba[4];
+
+	half::ToFloat4Scalar(&half_color.red, color_rgba);
+
+	const BenchPixel32 float_color = { 1.0f, color_rgba[0], color_rgba[1], color_rgba[2] };
+
+	const ImageView<const PixelHalf> half_in(half_src.data(), w, h, w * sizeof(PixelHalf));
+
+	const ImageView<PixelHalf> half_out(half_dst.data(), w, h, w * sizeof(PixelHalf));
+
+	const ImageView<const BenchPixel32> float_in(float_src.data(), w, h, w * sizeof(BenchPixel32));
+
+	const ImageView<BenchPixel32> float_out(float_dst.data(), w, h, w * sizeof(BenchPixel32));
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage = COVERAGE_HARD; coverage <= COVERAGE_SMOOTHSTEP; ++coverage)
+
+		{
+
+			const Geometry geom = MakeGeometry(mode, 150.3, 101.7, 0.3f, 60.0f, 1.0f, 1.0f, coverage, 3.0f);
+
+			RenderView(half_in, half_out, geom, half_color);
+
+			RenderView(float_in, float_out, geom, float_color);
+
+			for (std::size_t i = 0; i < half_dst.size(); ++i)
+
+			{
+
+				const BenchPixel32 &f = float_dst[i];
+
+				const float rgba[4] = { f.red, f.green, f.blue, f.alpha };
+
+				PixelHalf expected;
+
+				half::FromFloat4Scalar(rgba, &expected.red);
+
+				if (std::memcmp(&expected, &half_dst[i], sizeof(PixelHalf)) != 0)
+
+				{
+
+					Fail("mode %d coverage %d pixel (%d, %d): half %04x %04x %04x %04x, float rounded %04x %04x %04x %04x",
+						mode, coverage, static_cast<int>(i % w), static_cast<int>(i / w),
+						half_dst[i].red, half_dst[i].green, half_dst[i].blue, half_dst[i].alpha,
+						expected.red, expected.green, expected.blue, expected.alpha);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Y'CbCr (sep_color_Planar.h)
+
+// -------------------------------------------------------------
+
+// The per-sample reference for the planar kernels: ShadePixel's thresholds
+// around the fixed-point (integer) or float lerp toward the rounded fill
+template<typename SampleType>
+
+static SampleType ReferenceSample(SampleType in, float target, float coverage)
+
+{
+
+	const SampleType fill = static_cast<SampleType>(target + (std::is_floating_point<SampleType>::value ? 0.0f : 0.5f));
+
+	if (coverage <= Constants::COVERAGE_EPSILON)
+
+	{
+
+		return in;
+
+	}
+
+	if (coverage >= Constants::COVERAGE_FULL)
+
+	{
+
+		return fill;
+
+	}
+
+	if constexpr (std::is_floating_point<SampleType>::value)
+
+	{
+
+		return in + (target - in) * coverage;
+
+	}
+
+	else
+
+	{
+
+		return BlendFixed(in, fill, QuantizeCoverage(coverage));
+
+	}
+
+}
+
+// Effect color: BT.709 video-range red, and full-range 10-bit white
+static void CheckYCbCrColor()
+
+{
+
+	YCbCrFormat format;
+
+	format.matrix = MATRIX_BT709;
+
+	const YCbCrColor red = ColorToYCbCr(1.0f, 0.0f, 0.0f, format);
+
+	const float expected[3] = { 16.0f + 219.0f * 0.2126f, 128.0f - 224.0f * 0.2126f / (2.0f * (1.0f - 0.0722f)), 240.0f };
+
+	const float actual[3] = { red.y, red.cb, red.cr };
+
+	for (int i = 0; i < 3; ++i)
+
+	{
+
+		if (std::fabs(actual[i] - expected[i]) > 0.01f)
+
+		{
+
+			Fail("BT.709 red component %d: %f, expected %f", i, actual[i], expected[i]);
+
+		}
+
+	}
+
+	format.bit_depth = 10;
+
+	format.full_range = true;
+
+	const YCbCrColor white = ColorToYCbCr(1.0f, 1.0f, 1.0f, format);
+
+	if (std::fabs(white.y - 1023.0f) > 0.01f || std::fabs(white.cb - 512.0f) > 0.01f || std::fabs(white.cr - 512.0f) > 0.01f)
+
+	{
+
+		Fail("full-range 10-bit white: %f %f %f", white.y, white.cb, white.cr);
+
+	}
+
+}
+
+// Every luma sample follows the per-pixel Coverage() reference; every chroma
+// sample uses the box average of the luma coverages it spans. Odd frame
+// sizes, an even layer origin, 8 and 10 bit, 4:4:4 / 4:2:2 / 4:2:0, and in
+// place against out of place.
+template<typename SampleType>
+
+static void CheckYCbCrFormat(ChromaSubsampling subsampling, int bit_depth)
+
+{
+
+	const int w = 301;
+
+	const int h = 203;
+
+	const int origin_x = 40;
+
+	const int origin_y = -20;
+
+	YCbCrFormat format;
+
+	format.subsampling = subsampling;
+
+	format.bit_depth = bit_depth;
+
+	YCbCrView<SampleType> views[3];
+
+	std::vector<SampleType> planes[9];
+
+	std::mt19937 rng(11);
+
+	for (int v = 0; v < 3; ++v)
+
+	{
+
+		views[v].format = format;
+
+		planes[v * 3].resize(static_cast<std::size_t>(w) * h);
+
+		views[v].y = ImageView<SampleType>(planes[v * 3].data(), w, h, w * sizeof(SampleType), origin_x, origin_y);
+
+		const int cw = (w + (1 << views[v].ChromaShiftX()) - 1) >> views[v].ChromaShiftX();
+
+		const int ch = views[v].ChromaHeight();
+
+		planes[v * 3 + 1].resize(static_cast<std::size_t>(cw) * ch);
+
+		planes[v * 3 + 2].resize(static_cast<std::size_t>(cw) * ch);
+
+		views[v].cb = ImageView<SampleType>(planes[v * 3 + 1].data(), cw, ch, cw * sizeof(SampleType));
+
+		views[v].cr = ImageView<SampleType>(planes[v * 3 + 2].data(), cw, ch, cw * sizeof(SampleType));
+
+	}
+
+	for (int p = 0; p < 3; ++p)
+
+	{
+
+		for (SampleType &sample : planes[p])
+
+		{
+
+			sample = static_cast<SampleType>(rng() % (1u << bit_depth));
+
+		}
+
+		planes[6 + p] = planes[p];
+
+	}
+
+	const YCbCrView<const SampleType> src = views[0];
+
+	const YCbCrColor color = ColorToYCbCr(0.1f, 0.9f, 0.3f, format);
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		const Geometry geom = MakeGeometry(mode, origin_x + 150.5, origin_y + 101.25, 0.7f, 70.0f, 1.0f, 1.0f, COVERAGE_LINEAR, 5.0f);
+
+		RenderYCbCr(src, views[1], geom, color);
+
+		for (int p = 0; p < 3; ++p)
+
+		{
+
+			planes[6 + p] = planes[p];
+
+		}
+
+		RenderYCbCr(YCbCrView<const SampleType>(views[2]), views[2], geom, color);
+
+		for (int p = 0; p < 3; ++p)
+
+		{
+
+			if (planes[3 + p] != planes[6 + p])
+
+			{
+
+				Fail("%d-bit subsampling %d mode %d: plane %d differs in place", bit_depth, subsampling, mode, p);
+
+			}
+
+		}
+
+		for (int y = 0; y < h; ++y)
+
+		{
+
+			for (int x = 0; x < w; ++x)
+
+			{
+
+				const SampleType expected = ReferenceSample(src.y.Row(y)[x], color.y, Coverage(geom, origin_x + x, origin_y + y));
+
+				if (views[1].y.Row(y)[x] != expected)
+
+				{
+
+					Fail("%d-bit subsampling %d mode %d: Y(%d, %d) = %d, expected %d", bit_depth, subsampling, mode, x, y, views[1].y.Row(y)[x], expected);
+
+				}
+
+			}
+
+		}
+
+		const int sx = src.ChromaShiftX();
+
+		const int sy = src.ChromaShiftY();
+
+		for (int cy = 0; cy < src.ChromaHeight(); ++cy)
+
+		{
+
+			for (int cx = 0; cx < src.cb.width; ++cx)
+
+			{
+
+				float sum = 0.0f;
+
+				int count = 0;
+
+				for (int y = cy << sy; y < std::min(h, (cy + 1) << sy); ++y)
+
+				{
+
+					for (int x = cx << sx; x < std::min(w, (cx + 1) << sx); ++x)
+
+					{
+
+						sum += Coverage(geom, origin_x + x, origin_y + y);
+
+						++count;
+
+					}
+
+				}
+
+				const float coverage = sum / static_cast<float>(count);
+
+				const SampleType expected_cb = ReferenceSample(src.cb.Row(cy)[cx], color.cb, coverage);
+
+				const SampleType expected_cr = ReferenceSample(src.cr.Row(cy)[cx], color.cr, coverage);
+
+				if (views[1].cb.Row(cy)[cx] != expected_cb || views[1].cr.Row(cy)[cx] != expected_cr)
+
+				{
+
+					Fail("%d-bit subsampling %d mode %d: CbCr(%d, %d) = %d %d, expected %d %d", bit_depth, subsampling, mode, cx, cy,
+						views[1].cb.Row(cy)[cx], views[1].cr.Row(cy)[cx], expected_cb, expected_cr);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+static void CheckYCbCr()
+
+{
+
+	for (ChromaSubsampling subsampling : { CHROMA_444, CHROMA_422, CHROMA_420 })
+
+	{
+
+		CheckYCbCrFormat<std::uint8_t>(subsampling, 8);
+
+		CheckYCbCrFormat<std::uint16_t>(subsampling, 10);
+
+	}
+
+}
+
+// -------------------------------------------------------------
+
+// Planar RGB(A) (sep_color_Planar.h)
+
+// -------------------------------------------------------------
+
+// Planar output equals the interleaved render of the same pixels, channel
+// for channel; a separate alpha plane is copied, a shared one left alone
+template<typename PixelType>
+
+static void CheckPlanarDepth(PixelType color)
+
+{
+
+	using Sample = typename PixelTraits<PixelType>::ChannelType;
+
+	const int w = 777;
+
+	const int h = 301;
+
+	const float max_channel = PixelTraits<PixelType>::MAX_CHANNEL;
+
+	std::vector<PixelType> pixels(static_cast<std::size_t>(w) * h), shaded(pixels.size());
+
+	std::vector<Sample> planes[7];
+
+	for (std::vector<Sample> &plane : planes)
+
+	{
+
+		plane.resize(pixels.size());
+
+	}
+
+	std::mt19937 rng(9);
+
+	for (std::size_t i = 0; i < pixels.size(); ++i)
+
+	{
+
+		Sample v[4];
+
+		for (int c = 0; c < 4; ++c)
+
+		{
+
+			const float unit = static_cast<float>(rng() % 10001) / 10000.0f;
+
+			v[c] = static_cast<Sample>(PixelTraits<PixelType>::IsFloat ? unit : std::floor(unit * max_channel));
+
+			planes[c][i] = v[c];
+
+		}
+
+		pixels[i].red = v[0];
+
+		pixels[i].green = v[1];
+
+		pixels[i].blue = v[2];
+
+		pixels[i].alpha = v[3];
+
+	}
+
+	const std::ptrdiff_t plane_bytes = w * sizeof(Sample);
+
+	PlanarView<Sample> src, dst;
+
+	src.red = ImageView<Sample>(planes[0].data(), w, h, plane_bytes, -30, 12);
+
+	src.green = ImageView<Sample>(planes[1].data(), w, h, plane_bytes, -30, 12);
+
+	src.blue = ImageView<Sample>(planes[2].data(), w, h, plane_bytes, -30, 12);
+
+	src.alpha = ImageView<Sample>(planes[3].data(), w, h, plane_bytes, -30, 12);
+
+	dst = src;
+
+	dst.red.data = planes[4].data();
+
+	dst.green.data = planes[5].data();
+
+	dst.blue.data = planes[6].data();
+
+	const PlanarColor planar_color = { static_cast<float>(color.red), static_cast<float>(color.green), static_cast<float>(color.blue) };
+
+	const ImageView<const PixelType> pixels_in(pixels.data(), w, h, w * sizeof(PixelType), -30, 12);
+
+	const ImageView<PixelType> pixels_out(shaded.data(), w, h, w * sizeof(PixelType), -30, 12);
+
+	for (int mode = MODE_LINE; mode <= MODE_CIRCLE; ++mode)
+
+	{
+
+		for (int coverage : { COVERAGE_HARD, COVERAGE_LINEAR, COVERAGE_AREA, COVERAGE_GAUSSIAN })
+
+		{
+
+			const Geometry geom = MakeGeometry(mode, 370.0, 160.0, 1.1f, 120.0f, 1.0f, 1.0f, coverage, 3.0f);
+
+			RenderView(pixels_in, pixels_out, geom, color);
+
+			RenderPlanar(PlanarView<const Sample>(src), dst, geom, planar_color);
+
+			for (std::size_t i = 0; i < pixels.size(); ++i)
+
+			{
+
+				const PixelType &p = shaded[i];
+
+				if (p.red != planes[4][i] || p.green != planes[5][i] || p.blue != planes[6][i])
+
+				{
+
+					Fail("%s mode %d coverage %d pixel %d: interleaved %g %g %g, planar %g %g %g", sizeof(Sample) == 1 ? "8-bit" : sizeof(Sample) == 2 ? "16-bit" : "float",
+						mode, coverage, static_cast<int>(i), static_cast<double>(p.red), static_cast<double>(p.green), static_cast<double>(p.blue),
+						static_cast<double>(planes[4][i]), static_cast<double>(planes[5][i]), static_cast<double>(planes[6][i]));
+
+				}
+
+			}
+
+		}
+
+	}
+
+	// Separate alpha plane: copied. Shared plane: untouched.
+	std::vector<Sample> alpha_out(pixels.size());
+
+	PlanarView<Sample> with_alpha = dst;
+
+	with_alpha.alpha.data = alpha_out.data();
+
+	const Geometry geom = MakeGeometry(MODE_CIRCLE, 370.0, 160.0, 0.0f, 120.0f, 1.0f, 1.0f);
+
+	RenderPlanar(PlanarView<const Sample>(src), with_alpha, geom, planar_color);
+
+	if (alpha_out != planes[3])
+
+	{
+
+		Fail("separate alpha plane not copied");
+
+	}
+
+	const std::vector<Sample> alpha_before = planes[3];
+
+	RenderPlanar(PlanarView<const Sample>(src), dst, geom, planar_color);
+
+	if (planes[3] != alpha_before)
+
+	{
+
+		Fail("shared alpha plane modified");
+
+	}
+
+}
+
+static void CheckPlanar()
+
+{
+
+	CheckPlanarDepth(BenchPixel8{ 255, 200, 3, 77 });
+
+	CheckPlanarDepth(BenchPixel16{ 32768, 20000, 3, 32768 });
+
+	CheckPlanarDepth(BenchPixel32{ 1.0f, 0.2f, 0.7f, 1.0f });
+
+}
+
+// -------------------------------------------------------------
+
+// Runner
+
+// -------------------------------------------------------------
+
+struct Check
+{
+	const char *name;
+	void (*run)();
+};
+
+static const Check CHECKS[] = {
+	{ "rows-vs-per-pixel", CheckRowsVsPerPixel },
+	{ "isa-thread-matrix", CheckIsaMatrix },
+	{ "delta-vs-full", CheckDelta },
+	{ "no-allocation", CheckNoAllocation },
+	{ "cancel-16k", CheckCancel },
+	{ "preview-governors", CheckPreviewGovernors },
+	{ "draft-coverage", CheckDraftCoverage },
+	{ "area-coverage", CheckAreaCoverage },
+	{ "downsampled-vs-decimated", CheckDownsampled },
+	{ "large-layer-precision", CheckLargeLayer },
+	{ "half-conversions", CheckHalfConversions },
+	{ "half-vs-float", CheckHalfVsFloat },
+	{ "ycbcr-color", CheckYCbCrColor },
+	{ "ycbcr-vs-reference", CheckYCbCr },
+	{ "planar-vs-interleaved", CheckPlanar }
+};
+
+static bool ParseArgs(int argc, char **argv)
+
+{
+
+	for (int i = 1; i < argc; ++i)
+
+	{
+
+		const std::string arg = argv[i];
+
+		const bool has_value = i + 1 < argc;
+
+		if (arg == "--filter" && has_value)
+
+		{
+
+			g_options.filter = argv[++i];
+
+		}
+
+		else if (arg == "--threads" && has_value)
+
+		{
+
+			g_options.threads = std::max(0, std::atoi(argv[++i]));
+
+		}
+
+		else
+
+		{
+
+			std::fprintf(stderr, "usage: %s [--filter TEXT] [--threads N]\n", argv[0]);
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+int main(int argc, char **argv)
+
+{
+
+	if (!ParseArgs(argc, argv))
+
+	{
+
+		return 2;
+
+	}
+
+	SetSimdIsa(DetectSimdIsa());
+
+	std::printf("# sep_color check: ISA %d, F16C %d, %d threads\n", static_cast<int>(ActiveSimdIsa()), half::HasF16C() ? 1 : 0, CheckThreads());
+
+	int failed = 0;
+
+	int run = 0;
+
+	for (const Check &check : CHECKS)
+
+	{
+
+		if (!g_options.filter.empty() && std::string(check.name).find(g_options.filter) == std::string::npos)
+
+		{
+
+			continue;
+
+		}
+
+		g_failures = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		check.run();
+
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::printf("%s %-28s %10.1f ms%s\n", g_failures == 0 ? "PASS" : "FAIL", check.name, ms,
+			g_failures > 8 ? " (more failures not shown)" : "");
+
+		failed += g_failures != 0 ? 1 : 0;
+
+		++run;
+
+	}
+
+	std::printf("# %d of %d checks passed\n", run - failed, run);
+
+	return failed != 0 ? 1 : 0;
+
+}